@@ -5,13 +5,13 @@
 
 namespace Json
 {
-	void LogError(const char* condition, const char* file, int line, const char* message)
+	inline void LogError(const char* condition, const char* file, int line, const char* message)
 	{
 		std::cerr << "Failed " << condition << ", " << message << ", File: " << file << ", Line: " << line;
 		assert(true);
 	}
 
-	void LogError(const char* file, int line, const char* message)
+	inline void LogError(const char* file, int line, const char* message)
 	{
 		std::cerr << "Failed " << message << ", File: " << file << ", Line: " << line;
 		assert(true);
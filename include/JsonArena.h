@@ -0,0 +1,65 @@
+#ifndef JSON_ARENA_H
+#define JSON_ARENA_H
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+using std::vector;
+
+namespace Json
+{
+	/** Bump allocator handing out memory from fixed size chunks.
+	*	Individual deallocations are ignored, memory is returned only by
+	*	'Release()' or destruction, one chunk at a time. Not thread safe. */
+	class JsonArena : public std::pmr::memory_resource
+	{
+	public:
+		static constexpr size_t defaultChunkSize = 1 << 20;
+
+		/** Allocations larger than 'chunkSize' get a chunk of their own.
+		* If 'useHugePages' is true, chunks are backed by huge pages where the system allows it. */
+		explicit JsonArena(size_t chunkSize = defaultChunkSize, bool useHugePages = false);
+		JsonArena(const JsonArena& other) = delete;
+		JsonArena& operator=(const JsonArena& other) = delete;
+		~JsonArena() override;
+
+		/** Free all chunks but the first one, which is kept for reuse.
+		* Everything allocated from the arena becomes invalid. */
+		void Release();
+
+		inline size_t GetChunkSize() const { return chunkSize; }
+		inline bool UsesHugePages() const { return useHugePages; }
+		/** Returns total size of allocated chunks. */
+		size_t GetBytesReserved() const;
+
+	protected:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* /*pointer*/, size_t /*bytes*/, size_t /*alignment*/) override {}
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	private:
+		struct Chunk
+		{
+			char* data;
+			size_t size;
+			// Whether 'data' is a page mapping instead of a heap block.
+			bool isMapped;
+			// Whether chunk holds a single oversized allocation.
+			bool isDedicated;
+		};
+
+		/** Allocate chunk of at least 'size' bytes, it becomes current unless 'isDedicated'. */
+		char* AddChunk(size_t size, bool isDedicated);
+		static void FreeChunk(const Chunk& chunk);
+
+	private:
+		size_t chunkSize;
+		bool useHugePages;
+		vector<Chunk> chunks;
+		// Free space of the current chunk.
+		char* current = nullptr;
+		char* chunkEnd = nullptr;
+	};
+}
+
+#endif // !JSON_ARENA_H
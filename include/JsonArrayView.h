@@ -0,0 +1,35 @@
+#ifndef JSON_ARRAY_VIEW_H
+#define JSON_ARRAY_VIEW_H
+#include <cstddef>
+
+namespace Json
+{
+	/** Read-only view of contiguous values, like 'std::span<const Value>'.
+	*	Does not own the values, see 'JsonObject::AsDoubleArray'. */
+	template<typename Value>
+	class JsonArrayView
+	{
+	public:
+		using value_type = Value;
+		using const_iterator = const Value*;
+
+		constexpr JsonArrayView() = default;
+		constexpr JsonArrayView(const Value* values, size_t count)
+			: values(values), count(count) {}
+
+		constexpr const Value* data() const { return values; }
+		constexpr size_t size() const { return count; }
+		constexpr bool empty() const { return count == 0; }
+
+		constexpr const_iterator begin() const { return values; }
+		constexpr const_iterator end() const { return values + count; }
+
+		constexpr const Value& operator[](size_t index) const { return values[index]; }
+
+	private:
+		const Value* values = nullptr;
+		size_t count = 0;
+	};
+}
+
+#endif // !JSON_ARRAY_VIEW_H
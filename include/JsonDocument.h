@@ -0,0 +1,62 @@
+#ifndef JSON_DOCUMENT_H
+#define JSON_DOCUMENT_H
+#include <string>
+#include "JsonArena.h"
+#include "JsonDomHandler.h"
+#include "JsonObject.h"
+#include "JsonReader.h"
+
+using std::string;
+
+namespace Json
+{
+	/** Parsed 'JsonObject' tree whose containers and strings are allocated
+	*	from an arena owned by the document, instead of one heap block each.
+	*	Destroying or reparsing the document frees the arena a chunk at a time
+	*	without visiting the tree. Read only, copy the root to modify it. */
+	class JsonDocument
+	{
+	public:
+		/** See 'JsonArena' for 'chunkSize' and 'useHugePages'. */
+		explicit JsonDocument(size_t chunkSize = JsonArena::defaultChunkSize, bool useHugePages = false);
+		// Handler references 'root' and 'arena'.
+		JsonDocument(const JsonDocument& other) = delete;
+		JsonDocument& operator=(const JsonDocument& other) = delete;
+
+		/** Parse JSON text from given begin to end, replacing the previous document. */
+		bool Parse(const char* beginText, const char* endText);
+		/** Parse JSON text from 'std::string' class. */
+		bool Parse(const string& json);
+
+		/** Remove document, keeps the first arena chunk. */
+		void Clear();
+
+		/** Getter for root value, null if nothing is parsed. */
+		inline const JsonObject& GetRoot() const { return root; }
+
+		/** Access root object value by name. */
+		inline const JsonObject& operator[](const char* key) const { return root[key]; }
+		inline const JsonObject& operator[](const string& key) const { return root[key]; }
+		inline const JsonObject& operator[](string_view key) const { return root[key]; }
+		inline const JsonObject& operator[](const JsonKey& key) const { return root[key]; }
+		/** Access root array element by index. */
+		inline const JsonObject& operator[](int index) const { return root[index]; }
+
+		/** Reader used for parsing, to set its mode, limits, projection and key table. Parsing uses one thread. */
+		inline JsonReader& GetReader() { return reader; }
+		/** Returns size of arena chunks held by the document. */
+		inline size_t GetBytesReserved() const { return arena.GetBytesReserved(); }
+
+		/** Get Error message. */
+		inline string GetErrorMessage() const { return reader.GetErrorMessage(); }
+
+	private:
+		// Declared first, so it outlives everything allocated in it.
+		JsonArena arena;
+		JsonReader reader;
+		JsonDomHandler handler;
+		JsonObject root;
+	};
+}
+
+#endif // !JSON_DOCUMENT_H
@@ -0,0 +1,89 @@
+#ifndef JSON_DOM_HANDLER_H
+#define JSON_DOM_HANDLER_H
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include "JsonKeyTable.h"
+#include "JsonObject.h"
+
+using std::string_view;
+using std::vector;
+
+namespace Json
+{
+	/** Reader event handler that builds 'JsonObject' tree.
+	*	Used by 'JsonReader' and 'JsonPushReader' for DOM parsing.
+	*	Values are written over the existing content of root: members, elements
+	*	and string buffers already there are reused and the rest is removed,
+	*	so parsing documents of the same shape into the same root allocates
+	*	nothing once the first one is built. */
+	class JsonDomHandler
+	{
+	public:
+		/** Handler must be given root by 'Reset' before use. */
+		JsonDomHandler() = default;
+		/** If 'borrowStrings' is true, strings and long lazy number tokens reference parsed text instead of being copied. */
+		explicit JsonDomHandler(JsonObject& root, bool borrowStrings = false);
+
+		bool Null();
+		bool Bool(bool value);
+		bool Int(int value);
+		bool UInt(unsigned int value);
+		bool Int64(int64_t value);
+		bool UInt64(uint64_t value);
+		bool Double(double value);
+		bool String(string_view value);
+		/** Number token kept unconverted, see 'JsonReader::SetLazyNumbers'. */
+		bool RawNumber(string_view token);
+		/** Array of numbers only, see 'JsonReader::SetPackedArrays'. */
+		bool Int64Array(const int64_t* values, size_t count);
+		bool DoubleArray(const double* values, size_t count);
+		bool Key(string_view key);
+		bool StartObject();
+		bool EndObject(size_t memberCount);
+		bool StartArray();
+		bool EndArray(size_t elementCount);
+
+		/** Drop unfinished containers, keeps allocated stack. */
+		void Reset();
+		/** Same as above, and write next document to 'root'.
+		* Content of 'root' is not reused if 'borrowStrings' is true. */
+		void Reset(JsonObject& root, bool borrowStrings = false);
+		/** Make root null after failed parse, instead of leaving it partially overwritten. */
+		void Discard();
+		/** Allocate containers and strings from 'arena' instead of the heap, nullptr (default) disables.
+		* Built values are valid until the arena is released and are not freed by their destructors. */
+		void SetArena(std::pmr::memory_resource* arena);
+		/** Reference member names stored in 'keyTable' instead of copying them, nullptr (default) disables. */
+		void SetKeyTable(JsonKeyTable* keyTable);
+
+	private:
+		/** Returns object to write next value to: root, member named by last key or next element. */
+		JsonObject& NextValue();
+		/** Mark 'value' as written if it is object member. */
+		void MarkVisited(JsonObject& value);
+		/** Returns member name for 'key': interned, or copied or borrowed as strings are. */
+		JsonString MakeName(string_view key);
+		/** Returns null-terminated copy of 'value' allocated in arena. */
+		const char* CopyToArena(string_view value);
+
+	private:
+		// Open object/array and position of its next member or element.
+		struct Frame
+		{
+			JsonObject* container;
+			size_t index;
+		};
+
+		JsonObject* root = nullptr;
+		// Value of the member named by last 'Key'.
+		JsonObject* memberValue = nullptr;
+		bool borrowStrings = false;
+		std::pmr::memory_resource* arena = nullptr;
+		JsonKeyTable* keyTable = nullptr;
+		vector<Frame> stack;
+	};
+}
+
+#endif // !JSON_DOM_HANDLER_H
@@ -0,0 +1,295 @@
+#ifndef JSON_ELEMENT_ARRAY_H
+#define JSON_ELEMENT_ARRAY_H
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+namespace Json
+{
+	/** Array elements stored directly behind a small header, in one allocation.
+	*	The array is a single pointer to that block, copying it copies the pointer,
+	*	so its owner releases it by 'Destroy' and copies it by 'Clone'.
+	*	Empty arrays have no block unless they are created with a memory resource.
+	*	Adding or removing elements invalidates iterators and references to elements. */
+	template<typename Value>
+	class JsonElementArray
+	{
+	public:
+		using value_type = Value;
+		using iterator = Value*;
+		using const_iterator = const Value*;
+
+		JsonElementArray() = default;
+
+		/** Returns empty array allocating from 'resource', nullptr uses the default resource. */
+		static JsonElementArray Create(std::pmr::memory_resource* resource)
+		{
+			JsonElementArray array;
+			if (resource != nullptr)
+				array.Reallocate(0, resource);
+			return array;
+		}
+
+		/** Destroy elements and free the block, the array becomes empty. */
+		void Destroy()
+		{
+			if (block == nullptr)
+				return;
+			clear();
+			block->resource->deallocate(block, BlockSize(block->capacity), alignof(Header));
+			block = nullptr;
+		}
+
+		/** Returns copy of the array and its elements, allocated from the default resource. */
+		JsonElementArray Clone() const
+		{
+			JsonElementArray copy;
+			if (empty())
+				return copy;
+			copy.reserve(size());
+			for (const Value& value : *this)
+				copy.emplace_back(value);
+			// Contents are the same, so is their hash.
+			uint64_t generation = block->hashGeneration.load(std::memory_order_acquire);
+			copy.cache_hash(block->hash.load(std::memory_order_relaxed), generation);
+			return copy;
+		}
+
+		inline iterator begin() { return Elements(); }
+		inline const_iterator begin() const { return Elements(); }
+		inline const_iterator cbegin() const { return Elements(); }
+		inline iterator end() { return Elements() + size(); }
+		inline const_iterator end() const { return Elements() + size(); }
+		inline const_iterator cend() const { return Elements() + size(); }
+
+		inline size_t size() const { return block != nullptr ? block->size : 0; }
+		inline size_t capacity() const { return block != nullptr ? block->capacity : 0; }
+		inline bool empty() const { return size() == 0; }
+		inline Value* data() { return Elements(); }
+		inline const Value* data() const { return Elements(); }
+
+		/** Returns memory resource the block is allocated from, the default one if there is no block. */
+		inline std::pmr::memory_resource* get_resource() const { return Resource(); }
+
+		/** Store 'hash' of the contents computed in 'generation' of the owner, nothing is stored if there is no block.
+		* Safe to call from several threads. */
+		void cache_hash(uint64_t hash, uint64_t generation) const
+		{
+			if (block == nullptr)
+				return;
+			block->hash.store(hash, std::memory_order_relaxed);
+			block->hashGeneration.store(generation, std::memory_order_release);
+		}
+
+		/** Return true and set 'hash' if it was stored by 'cache_hash' in 'generation'. */
+		bool cached_hash(uint64_t& hash, uint64_t generation) const
+		{
+			if (block == nullptr || block->hashGeneration.load(std::memory_order_acquire) != generation)
+				return false;
+			hash = block->hash.load(std::memory_order_relaxed);
+			return true;
+		}
+
+		/** Store 'data' the owner derives from the elements, nothing is stored if there is no block.
+		* It stays with the block until the owner takes it back by 'detach', before the elements change. */
+		void attach(void* data) const
+		{
+			if (block != nullptr)
+				block->attached.store(data, std::memory_order_release);
+		}
+
+		/** Returns data stored by 'attach' and not detached since, or nullptr. */
+		void* attached() const
+		{
+			return block != nullptr ? block->attached.load(std::memory_order_acquire) : nullptr;
+		}
+
+		/** Returns data stored by 'attach' and forgets it, the owner releases it. */
+		void* detach()
+		{
+			if (block == nullptr || block->attached.load(std::memory_order_relaxed) == nullptr)
+				return nullptr;
+			return block->attached.exchange(nullptr, std::memory_order_relaxed);
+		}
+
+		inline Value& operator[](size_t index) { return Elements()[index]; }
+		inline const Value& operator[](size_t index) const { return Elements()[index]; }
+
+		/** Same as above, but throws 'std::out_of_range' for index out of range. */
+		Value& at(size_t index)
+		{
+			if (index >= size())
+				throw std::out_of_range("JsonElementArray::at: index out of range.");
+			return Elements()[index];
+		}
+
+		const Value& at(size_t index) const
+		{
+			if (index >= size())
+				throw std::out_of_range("JsonElementArray::at: index out of range.");
+			return Elements()[index];
+		}
+
+		void reserve(size_t count)
+		{
+			if (count > capacity())
+				Reallocate(count, Resource());
+		}
+
+		template<typename... Args>
+		Value& emplace_back(Args&&... args)
+		{
+			if (size() == capacity())
+				Grow(size() + 1);
+			Value* value = new (Elements() + block->size) Value(std::forward<Args>(args)...);
+			block->size++;
+			return *value;
+		}
+
+		/** Replace elements with copies of 'count' values. */
+		void assign(const Value* values, size_t count)
+		{
+			clear();
+			reserve(count);
+			if (count == 0)
+				return;
+			Value* elements = Elements();
+			for (size_t i = 0; i < count; ++i)
+				new (elements + i) Value(values[i]);
+			block->size = static_cast<uint32_t>(count);
+		}
+
+		/** Insert 'value' before 'position', the following elements are moved up. */
+		iterator insert(const_iterator position, Value&& value)
+		{
+			size_t offset = position - cbegin();
+			emplace_back(std::move(value));
+			Value* elements = Elements();
+			for (size_t i = block->size - 1; i > offset; --i)
+				std::swap(elements[i], elements[i - 1]);
+			return elements + offset;
+		}
+
+		iterator erase(const_iterator position)
+		{
+			return erase(position, position + 1);
+		}
+
+		/** Remove [first, last), the following elements keep their order. */
+		iterator erase(const_iterator first, const_iterator last)
+		{
+			size_t offset = first - cbegin(), count = last - first;
+			if (count == 0)
+				return begin() + offset;
+
+			Value* elements = Elements();
+			for (size_t i = offset + count; i < block->size; ++i)
+				elements[i - count] = std::move(elements[i]);
+			for (size_t i = block->size - count; i < block->size; ++i)
+				elements[i].~Value();
+			block->size -= static_cast<uint32_t>(count);
+			return elements + offset;
+		}
+
+		/** Remove elements from the end or append default ones. */
+		void resize(size_t count)
+		{
+			if (count < size())
+				erase(cbegin() + count, cend());
+			else
+			{
+				reserve(count);
+				while (size() < count)
+					emplace_back();
+			}
+		}
+
+		/** Remove all elements, keeps the block. */
+		void clear()
+		{
+			if (block == nullptr)
+				return;
+			Value* elements = Elements();
+			for (size_t i = 0; i < block->size; ++i)
+				elements[i].~Value();
+			block->size = 0;
+		}
+
+		bool operator==(const JsonElementArray& other) const
+		{
+			if (size() != other.size())
+				return false;
+			for (size_t i = 0; i < size(); ++i)
+			{
+				if (!((*this)[i] == other[i]))
+					return false;
+			}
+			return true;
+		}
+
+		inline bool operator!=(const JsonElementArray& other) const { return !(*this == other); }
+
+	private:
+		struct Header
+		{
+			uint32_t size;
+			uint32_t capacity;
+			std::pmr::memory_resource* resource;
+			// Hash of contents stored by the owner and its generation, 0 if none, see 'cache_hash'.
+			std::atomic<uint64_t> hash;
+			std::atomic<uint64_t> hashGeneration;
+			// Data of the owner derived from the elements, see 'attach'.
+			std::atomic<void*> attached;
+		};
+
+		static constexpr size_t BlockSize(size_t capacity) { return sizeof(Header) + capacity * sizeof(Value); }
+
+		inline Value* Elements() const
+		{
+			return block != nullptr ? reinterpret_cast<Value*>(block + 1) : nullptr;
+		}
+
+		inline std::pmr::memory_resource* Resource() const
+		{
+			return block != nullptr ? block->resource : std::pmr::get_default_resource();
+		}
+
+		void Grow(size_t minCapacity)
+		{
+			size_t newCapacity = capacity() < 4 ? 4 : capacity() * 2;
+			Reallocate(newCapacity < minCapacity ? minCapacity : newCapacity, Resource());
+		}
+
+		/** Move elements to a new block of 'newCapacity' elements. */
+		void Reallocate(size_t newCapacity, std::pmr::memory_resource* resource)
+		{
+			static_assert(alignof(Value) <= alignof(Header), "Elements must fit alignment of header.");
+			Header* newBlock = new (resource->allocate(BlockSize(newCapacity), alignof(Header))) Header();
+			newBlock->size = 0;
+			newBlock->capacity = static_cast<uint32_t>(newCapacity);
+			newBlock->resource = resource;
+			if (block != nullptr)
+			{
+				Value* elements = Elements();
+				Value* newElements = reinterpret_cast<Value*>(newBlock + 1);
+				for (size_t i = 0; i < block->size; ++i)
+				{
+					new (newElements + i) Value(std::move(elements[i]));
+					elements[i].~Value();
+				}
+				newBlock->size = block->size;
+				block->resource->deallocate(block, BlockSize(block->capacity), alignof(Header));
+			}
+			block = newBlock;
+		}
+
+	private:
+		Header* block = nullptr;
+	};
+}
+
+#endif // !JSON_ELEMENT_ARRAY_H
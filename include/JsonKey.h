@@ -0,0 +1,85 @@
+#ifndef JSON_KEY_H
+#define JSON_KEY_H
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+using std::string_view;
+
+namespace Json
+{
+	/** Member name with its lookup hash computed once, for names looked up repeatedly.
+	*	References the characters of the name, which must outlive the key.
+	*	Keys of literal names are hashed at compile time, see 'JSON_KEY' and '_jk'. */
+	class JsonKey
+	{
+	public:
+		constexpr JsonKey(string_view name)
+			: name(name), hash(HashName(name)), tag(MakeTag(name)) {}
+		constexpr JsonKey(const char* name)
+			: JsonKey(string_view(name)) {}
+
+		constexpr string_view View() const { return name; }
+		constexpr size_t Hash() const { return hash; }
+		constexpr uint32_t Tag() const { return tag; }
+
+		/** Returns hash of 'name' used by object member indexes. */
+		static constexpr size_t HashName(string_view name)
+		{
+			// Multiply-xorshift over 8 bytes at a time, loads are assembled from bytes to stay constexpr.
+			constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+			uint64_t hash = name.length() * multiplier;
+			size_t i = 0;
+			for (; i + 8 <= name.length(); i += 8)
+				hash = (hash ^ Load(name, i, 8)) * multiplier;
+			if (i < name.length())
+				hash = (hash ^ Load(name, i, name.length() - i)) * multiplier;
+			// Final avalanche, so index slots taken from low bits depend on every byte.
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 33;
+			return static_cast<size_t>(hash);
+		}
+
+		/** Returns short tag of 'name', equal names have equal tags. */
+		static constexpr uint32_t MakeTag(string_view name)
+		{
+			// Length with first, middle and last characters tell most names apart.
+			if (name.empty())
+				return 0;
+			size_t length = name.length();
+			return (static_cast<uint32_t>(length) << 24) ^ (static_cast<uint32_t>(static_cast<uint8_t>(name[0])) << 16) ^
+				(static_cast<uint32_t>(static_cast<uint8_t>(name[length / 2])) << 8) ^ static_cast<uint8_t>(name[length - 1]);
+		}
+
+	private:
+		/** Returns 'count' (at most 8) bytes of 'name' from 'offset' as little endian integer. */
+		static constexpr uint64_t Load(string_view name, size_t offset, size_t count)
+		{
+			uint64_t value = 0;
+			for (size_t i = 0; i < count; ++i)
+				value |= static_cast<uint64_t>(static_cast<uint8_t>(name[offset + i])) << (i * 8);
+			return value;
+		}
+
+	private:
+		string_view name;
+		size_t hash;
+		uint32_t tag;
+	};
+
+	inline namespace Literals
+	{
+		/** Key of a literal name, "timestamp"_jk. Hashed at compile time
+		* when used in a constant expression, such as a 'constexpr' variable. */
+		constexpr JsonKey operator""_jk(const char* name, size_t length)
+		{
+			return JsonKey(string_view(name, length));
+		}
+	}
+}
+
+/** Key of literal 'name' hashed at compile time, JSON_KEY("timestamp"). */
+#define JSON_KEY(name) ([]() { constexpr ::Json::JsonKey key(name); return key; }())
+
+#endif // !JSON_KEY_H
@@ -0,0 +1,44 @@
+#ifndef JSON_KEY_TABLE_H
+#define JSON_KEY_TABLE_H
+#include <cstddef>
+#include <string_view>
+#include <unordered_set>
+#include "JsonArena.h"
+
+using std::string_view;
+
+namespace Json
+{
+	/** Set of member names shared by documents parsed with it, see 'JsonReader::SetKeyTable'.
+	*	Each distinct name is stored once and parsed objects reference it instead of
+	*	holding a copy, so the table must outlive those documents. Not thread safe. */
+	class JsonKeyTable
+	{
+	public:
+		/** Names are stored in chunks of 'chunkSize' bytes. */
+		explicit JsonKeyTable(size_t chunkSize = 64 * 1024);
+		JsonKeyTable(const JsonKeyTable& other) = delete;
+		JsonKeyTable& operator=(const JsonKeyTable& other) = delete;
+
+		/** Returns stored null-terminated copy of 'name', adding it if it is new.
+		* Equal names always return the same characters, valid until 'Clear()'. */
+		string_view Intern(string_view name);
+		/** Returns stored copy of 'name', or view with null data if it is not stored. */
+		string_view Find(string_view name) const;
+
+		/** Returns number of distinct names. */
+		inline size_t Size() const { return names.size(); }
+		/** Returns size of chunks holding names. */
+		inline size_t GetBytesReserved() const { return storage.GetBytesReserved(); }
+
+		/** Remove all names, documents referencing them become invalid. */
+		void Clear();
+
+	private:
+		JsonArena storage;
+		// Views of characters in 'storage'.
+		std::unordered_set<string_view> names;
+	};
+}
+
+#endif // !JSON_KEY_TABLE_H
@@ -0,0 +1,128 @@
+#ifndef JSON_LAZY_DOCUMENT_H
+#define JSON_LAZY_DOCUMENT_H
+#include <string>
+#include "JsonObject.h"
+
+using std::string;
+
+namespace Json
+{
+	/** Cursor to a value inside the text of 'JsonLazyDocument'.
+	*	Nothing is parsed until the value is accessed, members and elements
+	*	are found by skipping over preceding values without building them.
+	*	Mirrors read access of 'JsonObject'. Text is validated only
+	*	as far as it is read, so malformed parts that are never reached go unnoticed. */
+	class JsonLazyValue
+	{
+	public:
+		/** Create missing value, it behaves like null. */
+		JsonLazyValue() = default;
+
+#pragma region UnaryOperators
+		/** Access an object value by name.
+		* Returns missing value if there is no such member or this is not object. */
+		JsonLazyValue operator[](const char* key) const;
+		JsonLazyValue operator[](const string& key) const;
+
+		/** Access an array element by index.
+		* Returns missing value if out of range or this is not array. */
+		JsonLazyValue operator[](int index) const;
+#pragma endregion
+
+		/** Return true if this object has member of specified key, otherwise false. */
+		bool IsMember(const char* key) const;
+		bool IsMember(const string& key) const;
+
+		/** Return number of values in object/array, counting them by skipping.
+		* Return 0 if this value is not object/array type. */
+		int Size() const;
+
+		/** Return true if value exists in the document. */
+		inline bool IsValid() const { return start != nullptr; }
+
+		/** Getter for value type, numbers are parsed to find it. */
+		ValueType GetType() const;
+
+#pragma region Conversion Checkers
+		bool IsNumeric() const;
+		inline bool IsNull() const { return GetType() == ValueType::Null; }
+		inline bool IsString() const { return start != nullptr && *start == '"'; }
+		inline bool IsBool() const { return GetType() == ValueType::Bool; }
+		inline bool IsObject() const { return start != nullptr && *start == '{'; }
+		inline bool IsArray() const { return start != nullptr && *start == '['; }
+#pragma endregion
+
+#pragma region Converters
+		string AsString() const;
+		bool AsBool() const;
+		int AsInt() const;
+		unsigned int AsUInt() const;
+		float AsFloat() const;
+		int64_t AsInt64() const;
+		uint64_t AsUInt64() const;
+		double AsDouble() const;
+
+		bool AsString(string& value) const;
+		bool AsBool(bool& value) const;
+		bool AsInt(int& value) const;
+		bool AsUInt(unsigned int& value) const;
+		bool AsFloat(float& value) const;
+		bool AsInt64(int64_t& value) const;
+		bool AsUInt64(uint64_t& value) const;
+		bool AsDouble(double& value) const;
+#pragma endregion
+
+		/** Parse this value and everything in it into 'object'.
+		* Returns false if its text is malformed. */
+		bool ToObject(JsonObject& object) const;
+
+	private:
+		friend class JsonLazyDocument;
+		JsonLazyValue(const char* start, const char* end)
+			: start(start), end(end) {}
+
+		/** Find member value by name, member names with escapes are decoded to compare. */
+		JsonLazyValue FindMember(const char* key, size_t keyLength) const;
+		/** Parse string, number or literal value.
+		* Returns false for containers, missing values and malformed text. */
+		bool ParseScalar(JsonObject& object) const;
+		/** Same as above, but returns null on failure. */
+		JsonObject ToScalar() const;
+
+	private:
+		// First character of the value, nullptr if missing.
+		const char* start = nullptr;
+		// End of document text.
+		const char* end = nullptr;
+	};
+
+	/** On-demand view of JSON text.
+	*	Text is referenced, not copied, and must outlive the document and its values. */
+	class JsonLazyDocument
+	{
+	public:
+		/** Reference JSON text from given begin to end.
+		* Returns false if root is not an object or array. */
+		bool Load(const char* beginText, const char* endText);
+		/** Reference JSON text of 'std::string' class. */
+		bool Load(const string& json);
+
+		/** Getter for root value. */
+		inline JsonLazyValue GetRoot() const { return root; }
+
+		/** Access root object value by name. */
+		inline JsonLazyValue operator[](const char* key) const { return root[key]; }
+		inline JsonLazyValue operator[](const string& key) const { return root[key]; }
+		/** Access root array element by index. */
+		inline JsonLazyValue operator[](int index) const { return root[index]; }
+
+		/** Get Error message. */
+		inline const string& GetErrorMessage() const { return errorMessage; }
+
+	private:
+		JsonLazyValue root;
+		string errorMessage;
+	};
+}
+
+#endif // !JSON_LAZY_DOCUMENT_H
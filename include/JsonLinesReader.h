@@ -0,0 +1,52 @@
+#ifndef JSON_LINES_READER_H
+#define JSON_LINES_READER_H
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "JsonObject.h"
+#include "JsonReader.h"
+
+using std::string;
+
+namespace Json
+{
+	/** Reader for newline delimited JSON (JSON Lines), one document per line.
+	*	Records are parsed concurrently by worker threads and delivered
+	*	to the callback in input order, on the calling thread. */
+	class JsonLinesReader
+	{
+	public:
+		/** Called for each record with its 1-based line number.
+		* Record may be moved from. Returning false stops reading. */
+		using RecordCallback = std::function<bool(size_t line, JsonObject& record)>;
+
+		/** 'threadCount' parsing threads are used, 0 means one per hardware thread. */
+		explicit JsonLinesReader(unsigned int threadCount = 0);
+
+		/** Set tokenization strategy of worker readers. */
+		inline void SetMode(ReaderMode mode) { this->mode = mode; }
+		/** Set how many records may be parsed but not yet delivered,
+		* this bounds memory held by parsed records. */
+		inline void SetMaxInFlight(size_t maxInFlight) { this->maxInFlight = maxInFlight != 0 ? maxInFlight : 1; }
+		inline size_t GetMaxInFlight() const { return maxInFlight; }
+
+		/** Parse records from given begin to end, blank lines are skipped.
+		* Returns false on first invalid record (records before it are delivered)
+		* or if callback stopped reading. */
+		bool Parse(const char* beginText, const char* endText, const RecordCallback& callback);
+		/** Parse records of memory mapped file. */
+		bool ParseFile(const string& path, const RecordCallback& callback);
+
+		/** Get Error message. */
+		inline const string& GetErrorMessage() const { return errorMessage; }
+
+	private:
+		unsigned int threadCount;
+		ReaderMode mode = ReaderMode::Scalar;
+		size_t maxInFlight = 1024;
+
+		string errorMessage;
+	};
+}
+
+#endif // !JSON_LINES_READER_H
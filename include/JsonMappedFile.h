@@ -0,0 +1,53 @@
+#ifndef JSON_MAPPED_FILE_H
+#define JSON_MAPPED_FILE_H
+#include <cstddef>
+#include <string>
+
+using std::string;
+
+namespace Json
+{
+	/** Read-only memory mapping of a whole file.
+	*	Mapping is exactly file size long, bytes after 'End()' up to the
+	*	page boundary (or the next page, if size is page aligned)
+	*	must not be read, so users must stay within [Begin(), End()). */
+	class JsonMappedFile
+	{
+	public:
+		JsonMappedFile() = default;
+		JsonMappedFile(const JsonMappedFile& other) = delete;
+		JsonMappedFile& operator=(const JsonMappedFile& other) = delete;
+		~JsonMappedFile();
+
+		/** Map file for sequential reading, closes previous mapping.
+		* Returns false on failure, see 'GetErrorMessage()'. */
+		bool Open(const char* path);
+		/** Unmap file. */
+		void Close();
+
+		inline bool IsOpen() const { return data != nullptr; }
+		inline const char* Begin() const { return data; }
+		inline const char* End() const { return data + size; }
+		inline size_t Size() const { return size; }
+
+		/** Get Error message. */
+		inline const string& GetErrorMessage() const { return errorMessage; }
+
+	private:
+		/** Set Error message and close mapping. */
+		bool SetError(const char* message, const char* path);
+
+	private:
+		const char* data = nullptr;
+		size_t size = 0;
+		// Whether 'data' is a mapping, empty files are not mapped.
+		bool isMapped = false;
+#ifdef _WIN32
+		void* mappingHandle = nullptr;
+#endif
+
+		string errorMessage;
+	};
+}
+
+#endif // !JSON_MAPPED_FILE_H
@@ -0,0 +1,421 @@
+#ifndef JSON_MEMBER_MAP_H
+#define JSON_MEMBER_MAP_H
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <utility>
+#include "JsonKey.h"
+#include "JsonString.h"
+
+using std::string_view;
+
+namespace Json
+{
+	/** Name lookup helpers of 'JsonMemberMap', independent of its value type. */
+	class JsonMemberMapBase
+	{
+	protected:
+		/** Returns position of the first 'tag' in [tags + start, tags + count), or 'count'. */
+		static size_t FindTag(const uint32_t* tags, size_t count, size_t start, uint32_t tag);
+	};
+
+	/** Object members stored in insertion order directly behind a small header,
+	*	followed by a tag per member, all in one allocation.
+	*	Small objects are searched by scanning the tags, objects with more than
+	*	'indexThreshold' members also keep an open addressing index of positions.
+	*	The map is a single pointer to its block, copying it copies the pointer,
+	*	so its owner releases it by 'Destroy' and copies it by 'Clone'.
+	*	Adding or removing members invalidates iterators and references to members. */
+	template<typename Value>
+	class JsonMemberMap : private JsonMemberMapBase
+	{
+	public:
+		using value_type = std::pair<JsonString, Value>;
+		using iterator = value_type*;
+		using const_iterator = const value_type*;
+
+		static constexpr size_t indexThreshold = 16;
+
+		JsonMemberMap() = default;
+
+		/** Returns empty map allocating from 'resource', nullptr uses the default resource. */
+		static JsonMemberMap Create(std::pmr::memory_resource* resource)
+		{
+			JsonMemberMap map;
+			if (resource != nullptr)
+				map.Reallocate(0, resource);
+			return map;
+		}
+
+		/** Destroy members and free the block, the map becomes empty. */
+		void Destroy()
+		{
+			if (block == nullptr)
+				return;
+			clear();
+			block->resource->deallocate(block, BlockSize(block->capacity), alignof(Header));
+			block = nullptr;
+		}
+
+		/** Returns copy of the map and its members, allocated from the default resource. */
+		JsonMemberMap Clone() const
+		{
+			JsonMemberMap copy;
+			if (empty())
+				return copy;
+			copy.Reallocate(size(), std::pmr::get_default_resource());
+			for (const value_type& member : *this)
+				new (copy.Members() + copy.block->size++) value_type(member);
+			std::copy(Tags(), Tags() + size(), copy.Tags());
+			copy.RebuildIndex();
+			// Contents are the same, so is their hash.
+			uint64_t generation = block->hashGeneration.load(std::memory_order_acquire);
+			copy.cache_hash(block->hash.load(std::memory_order_relaxed), generation);
+			return copy;
+		}
+
+		inline iterator begin() { return Members(); }
+		inline const_iterator begin() const { return Members(); }
+		inline const_iterator cbegin() const { return Members(); }
+		inline iterator end() { return Members() + size(); }
+		inline const_iterator end() const { return Members() + size(); }
+		inline const_iterator cend() const { return Members() + size(); }
+
+		inline size_t size() const { return block != nullptr ? block->size : 0; }
+		inline bool empty() const { return size() == 0; }
+
+		/** Store 'hash' of the contents computed in 'generation' of the owner, nothing is stored if there is no block.
+		* Safe to call from several threads. */
+		void cache_hash(uint64_t hash, uint64_t generation) const
+		{
+			if (block == nullptr)
+				return;
+			block->hash.store(hash, std::memory_order_relaxed);
+			block->hashGeneration.store(generation, std::memory_order_release);
+		}
+
+		/** Return true and set 'hash' if it was stored by 'cache_hash' in 'generation'. */
+		bool cached_hash(uint64_t& hash, uint64_t generation) const
+		{
+			if (block == nullptr || block->hashGeneration.load(std::memory_order_acquire) != generation)
+				return false;
+			hash = block->hash.load(std::memory_order_relaxed);
+			return true;
+		}
+
+		/** Remove all members, keeps the block. */
+		void clear()
+		{
+			if (block == nullptr)
+				return;
+			value_type* members = Members();
+			for (size_t i = 0; i < block->size; ++i)
+				members[i].~value_type();
+			block->size = 0;
+			ReleaseIndex();
+		}
+
+		void reserve(size_t count)
+		{
+			if (block == nullptr || count > block->capacity)
+				Reallocate(count, Resource());
+		}
+
+		/** Returns member named 'name', or 'end()'. */
+		inline iterator find(string_view name) { return begin() + FindPosition(name); }
+		inline const_iterator find(string_view name) const { return begin() + FindPosition(name); }
+		/** Same as above, without hashing the name again. */
+		inline iterator find(const JsonKey& key) { return begin() + FindPosition(key); }
+		inline const_iterator find(const JsonKey& key) const { return begin() + FindPosition(key); }
+
+		/** Append member if there is none named 'name'.
+		* Returns the member and whether it was added. */
+		std::pair<iterator, bool> emplace(JsonString&& name, Value&& value)
+		{
+			size_t position = FindPosition(name.View());
+			if (position != size())
+				return { begin() + position, false };
+
+			if (block == nullptr || block->size == block->capacity)
+				Reallocate(block == nullptr || block->capacity < 4 ? 4 : block->capacity * 2, Resource());
+			uint32_t tag = JsonKey::MakeTag(name.View());
+			new (Members() + block->size) value_type(std::move(name), std::move(value));
+			Tags()[block->size] = tag;
+			block->size++;
+			if (block->size > indexThreshold)
+			{
+				// Index is rebuilt larger once half full.
+				if (block->indexSize < block->size * 2)
+					RebuildIndex();
+				else
+					AddToIndex(block->size - 1);
+			}
+			return { end() - 1, true };
+		}
+
+		/** Remove member, the following ones keep their order. */
+		iterator erase(const_iterator position)
+		{
+			size_t offset = position - cbegin();
+			value_type* members = Members();
+			uint32_t* tags = Tags();
+			for (size_t i = offset + 1; i < block->size; ++i)
+			{
+				members[i - 1] = std::move(members[i]);
+				tags[i - 1] = tags[i];
+			}
+			members[block->size - 1].~value_type();
+			block->size--;
+			RebuildIndex();
+			return begin() + offset;
+		}
+
+		/** Move member at position 'from' to position 'to', members between them shift by one place.
+		* Keeps the block and the index, so nothing is allocated. */
+		void relocate(size_t from, size_t to)
+		{
+			if (from == to)
+				return;
+
+			value_type* members = Members();
+			uint32_t* tags = Tags();
+			size_t first = from < to ? from : to, last = from < to ? to : from;
+			if (from > to)
+			{
+				std::rotate(members + to, members + from, members + from + 1);
+				std::rotate(tags + to, tags + from, tags + from + 1);
+			}
+			else
+			{
+				std::rotate(members + from, members + from + 1, members + to + 1);
+				std::rotate(tags + from, tags + from + 1, tags + to + 1);
+			}
+
+			if (block->index == nullptr)
+				return;
+			// Slots keep their names, only positions in [first, last] changed.
+			for (size_t slot = 0; slot < block->indexSize; ++slot)
+			{
+				size_t position = block->index[slot];
+				if (position == 0 || position - 1 < first || position - 1 > last)
+					continue;
+				if (position - 1 == from)
+					position = to + 1;
+				else if (from > to)
+					++position;
+				else
+					--position;
+				block->index[slot] = static_cast<uint32_t>(position);
+			}
+		}
+
+		/** Remove members for which 'predicate(member)' returns true.
+		* It is called once per member in order, and may modify the value. Returns number of removed members. */
+		template<typename Predicate>
+		size_t erase_if(Predicate predicate)
+		{
+			if (block == nullptr)
+				return 0;
+
+			value_type* members = Members();
+			uint32_t* tags = Tags();
+			size_t kept = 0;
+			for (size_t i = 0; i < block->size; ++i)
+			{
+				if (predicate(members[i]))
+					continue;
+				if (kept != i)
+				{
+					members[kept] = std::move(members[i]);
+					tags[kept] = tags[i];
+				}
+				++kept;
+			}
+
+			size_t removed = block->size - kept;
+			if (removed != 0)
+			{
+				for (size_t i = kept; i < block->size; ++i)
+					members[i].~value_type();
+				block->size = static_cast<uint32_t>(kept);
+				RebuildIndex();
+			}
+			return removed;
+		}
+
+		/** Members are compared regardless of their order. */
+		bool operator==(const JsonMemberMap& other) const
+		{
+			if (size() != other.size())
+				return false;
+
+			const value_type* members = Members();
+			const value_type* otherMembers = other.Members();
+			for (size_t i = 0; i < size(); ++i)
+			{
+				// Members are usually in the same order, otherwise they are looked up.
+				const value_type* match = &otherMembers[i];
+				if (match->first != members[i].first)
+				{
+					size_t position = other.FindPosition(members[i].first.View());
+					if (position == other.size())
+						return false;
+					match = &otherMembers[position];
+				}
+				if (!(match->second == members[i].second))
+					return false;
+			}
+			return true;
+		}
+
+		inline bool operator!=(const JsonMemberMap& other) const { return !(*this == other); }
+
+	private:
+		struct Header
+		{
+			uint32_t size;
+			uint32_t capacity;
+			std::pmr::memory_resource* resource;
+			// Member position + 1 per slot, 0 for empty slots. nullptr for small objects.
+			uint32_t* index;
+			size_t indexSize;
+			// Hash of contents stored by the owner and its generation, 0 if none, see 'cache_hash'.
+			std::atomic<uint64_t> hash;
+			std::atomic<uint64_t> hashGeneration;
+		};
+
+		/** Header, members and their tags. */
+		static constexpr size_t BlockSize(size_t capacity)
+		{
+			return sizeof(Header) + capacity * (sizeof(value_type) + sizeof(uint32_t));
+		}
+
+		inline value_type* Members() const
+		{
+			return block != nullptr ? reinterpret_cast<value_type*>(block + 1) : nullptr;
+		}
+
+		// 'MakeTag' of each member name.
+		inline uint32_t* Tags() const
+		{
+			return reinterpret_cast<uint32_t*>(Members() + block->capacity);
+		}
+
+		inline std::pmr::memory_resource* Resource() const
+		{
+			return block != nullptr ? block->resource : std::pmr::get_default_resource();
+		}
+
+		/** Move members to a new block of 'newCapacity' members. */
+		void Reallocate(size_t newCapacity, std::pmr::memory_resource* resource)
+		{
+			static_assert(alignof(value_type) <= alignof(Header), "Members must fit alignment of header.");
+			Header* newBlock = new (resource->allocate(BlockSize(newCapacity), alignof(Header))) Header();
+			newBlock->size = 0;
+			newBlock->capacity = static_cast<uint32_t>(newCapacity);
+			newBlock->resource = resource;
+			newBlock->index = nullptr;
+			newBlock->indexSize = 0;
+			if (block != nullptr)
+			{
+				value_type* members = Members();
+				value_type* newMembers = reinterpret_cast<value_type*>(newBlock + 1);
+				for (size_t i = 0; i < block->size; ++i)
+				{
+					new (newMembers + i) value_type(std::move(members[i]));
+					members[i].~value_type();
+				}
+				std::copy(Tags(), Tags() + block->size, reinterpret_cast<uint32_t*>(newMembers + newCapacity));
+				newBlock->size = block->size;
+				// Index holds positions only, so it stays valid.
+				newBlock->index = block->index;
+				newBlock->indexSize = block->indexSize;
+				block->resource->deallocate(block, BlockSize(block->capacity), alignof(Header));
+			}
+			block = newBlock;
+		}
+
+		/** Returns position of member named 'name', or 'size()'. */
+		inline size_t FindPosition(string_view name) const
+		{
+			// Small objects need no hash.
+			if (block != nullptr && block->index != nullptr)
+				return FindIndexed(name, JsonKey::HashName(name));
+			return FindTagged(name, JsonKey::MakeTag(name));
+		}
+
+		inline size_t FindPosition(const JsonKey& key) const
+		{
+			if (block != nullptr && block->index != nullptr)
+				return FindIndexed(key.View(), key.Hash());
+			return FindTagged(key.View(), key.Tag());
+		}
+
+		size_t FindIndexed(string_view name, size_t hash) const
+		{
+			const value_type* members = Members();
+			size_t mask = block->indexSize - 1;
+			for (size_t slot = hash & mask; block->index[slot] != 0; slot = (slot + 1) & mask)
+			{
+				if (members[block->index[slot] - 1].first.Equals(name))
+					return block->index[slot] - 1;
+			}
+			return block->size;
+		}
+
+		size_t FindTagged(string_view name, uint32_t tag) const
+		{
+			if (block == nullptr)
+				return 0;
+			const value_type* members = Members();
+			const uint32_t* tags = Tags();
+			size_t position = FindTag(tags, block->size, 0, tag);
+			while (position != block->size && !members[position].first.Equals(name))
+				position = FindTag(tags, block->size, position + 1, tag);
+			return position;
+		}
+
+		void ReleaseIndex()
+		{
+			if (block->index == nullptr)
+				return;
+			block->resource->deallocate(block->index, block->indexSize * sizeof(uint32_t), alignof(uint32_t));
+			block->index = nullptr;
+			block->indexSize = 0;
+		}
+
+		void RebuildIndex()
+		{
+			ReleaseIndex();
+			if (block->size <= indexThreshold)
+				return;
+
+			size_t slotCount = indexThreshold * 4;
+			while (slotCount < block->size * 4)
+				slotCount *= 2;
+			block->index = static_cast<uint32_t*>(block->resource->allocate(slotCount * sizeof(uint32_t), alignof(uint32_t)));
+			block->indexSize = slotCount;
+			std::fill(block->index, block->index + slotCount, 0);
+			for (size_t i = 0; i < block->size; ++i)
+				AddToIndex(i);
+		}
+
+		void AddToIndex(size_t position)
+		{
+			size_t mask = block->indexSize - 1;
+			size_t slot = JsonKey::HashName(Members()[position].first.View()) & mask;
+			while (block->index[slot] != 0)
+				slot = (slot + 1) & mask;
+			block->index[slot] = static_cast<uint32_t>(position + 1);
+		}
+
+	private:
+		Header* block = nullptr;
+	};
+}
+
+#endif // !JSON_MEMBER_MAP_H
@@ -0,0 +1,46 @@
+#ifndef JSON_NUMBER_PARSER_H
+#define JSON_NUMBER_PARSER_H
+#include <cstdint>
+#include "JsonObject.h"
+
+namespace Json
+{
+	/** Locale-free, allocation-free parser of JSON number tokens.
+	*	Integers are accumulated directly, reals are converted with
+	*	Clinger's fast path, then Eisel-Lemire, then 'std::from_chars'
+	*	for the rare inputs neither can round correctly. */
+	class JsonNumberParser
+	{
+	public:
+		struct Number
+		{
+			// One of Int, UInt, Int64, UInt64 or Double.
+			ValueType type;
+			union
+			{
+				int64_t Int64;
+				uint64_t UInt64;
+				double Double;
+			};
+		};
+
+		/** Parse number token [begin, end) to the smallest fitting type:
+		* negative integers to Int/Int64, non-negative to UInt/UInt64,
+		* reals and out of range integers to Double.
+		* Returns false if text is not a valid JSON number. */
+		static bool Parse(const char* begin, const char* end, Number& number);
+		static bool Parse(const char* begin, const char* end, JsonObject& object);
+
+		/** Same as 'Parse', but only validate reals, integers out of 64-bit range
+		* and negative zero: their type is Double and value is not set. */
+		static bool ParseInteger(const char* begin, const char* end, Number& number);
+
+		/** Return true if [begin, end) is a valid JSON number, without converting it. */
+		static bool IsValid(const char* begin, const char* end);
+
+		/** Parse number token [begin, end) as correctly rounded double. */
+		static bool ParseDouble(const char* begin, const char* end, double& value);
+	};
+}
+
+#endif // !JSON_NUMBER_PARSER_H
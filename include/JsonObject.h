@@ -1,16 +1,28 @@
 #ifndef JSON_OBJECT_H
 #define JSON_OBJECT_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <istream>
+#include <iterator>
+#include <memory_resource>
+#include <new>
 #include <ostream>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
-#include <unordered_map>
+#include "JsonArrayView.h"
+#include "JsonElementArray.h"
+#include "JsonKey.h"
+#include "JsonMemberMap.h"
+#include "JsonString.h"
 
 using std::istream;
 using std::ostream;
 using std::string;
+using std::string_view;
 using std::vector;
-using std::unordered_map;
 
 class JsonObject;
 
@@ -25,21 +37,41 @@ namespace Json
 		Int,
 		UInt,
 		Float,
+		Int64,
+		UInt64,
+		Double,
 		Object,
 		Array
 	};
 
 	class JsonObject
 	{
+		// 'long' types with no constructor of their own, which would be ambiguous between the others.
+		template<typename Integer>
+		struct IsOtherLong : std::integral_constant<bool,
+			(std::is_same<Integer, long>::value || std::is_same<Integer, unsigned long>::value ||
+			std::is_same<Integer, long long>::value || std::is_same<Integer, unsigned long long>::value) &&
+			!std::is_same<Integer, int>::value && !std::is_same<Integer, unsigned int>::value &&
+			!std::is_same<Integer, int64_t>::value && !std::is_same<Integer, uint64_t>::value> {};
+
+		template<typename Integer>
+		struct SameWidthInteger
+		{
+			using Signed = typename std::conditional<sizeof(Integer) == sizeof(int64_t), int64_t, int>::type;
+			using Unsigned = typename std::conditional<sizeof(Integer) == sizeof(uint64_t), uint64_t, unsigned int>::type;
+			using type = typename std::conditional<std::is_signed<Integer>::value, Signed, Unsigned>::type;
+		};
+
 	public:
 		// static object that is considered as null.
 		static const JsonObject& NullSingleton();
 
 		/** Create a Default JsonObject of the given type. */
-		constexpr JsonObject(ValueType type = ValueType::Null);
+		JsonObject(ValueType type = ValueType::Null);
 		/** 'value' mast be null terminated. */
 		JsonObject(const char* value);
 		JsonObject(const string& value);
+		JsonObject(string_view value);
 		constexpr JsonObject(bool value)
 			: type(ValueType::Bool), _value(value) {}
 		constexpr JsonObject(int value)
@@ -48,25 +80,49 @@ namespace Json
 			: type(ValueType::UInt), _value(value) {}
 		constexpr JsonObject(float value)
 			: type(ValueType::Float), _value(value) {}
+		constexpr JsonObject(int64_t value)
+			: type(ValueType::Int64), _value(value) {}
+		constexpr JsonObject(uint64_t value)
+			: type(ValueType::UInt64), _value(value) {}
+		constexpr JsonObject(double value)
+			: type(ValueType::Double), _value(value) {}
+		/** 'long' and 'long long' types other than 'int64_t'/'uint64_t', such as 'long long' where 'int64_t' is 'long'.
+		* They are stored as the fixed width type of the same size and signedness. */
+		template<typename Integer, typename std::enable_if<IsOtherLong<Integer>::value, int>::type = 0>
+		constexpr JsonObject(Integer value)
+			: JsonObject(static_cast<typename SameWidthInteger<Integer>::type>(value)) {}
 		JsonObject(const JsonObject& other);
-		constexpr JsonObject(JsonObject&& other) noexcept;
+		JsonObject(JsonObject&& other) noexcept;
 		~JsonObject();
 
+		/** Create string value that references 'value' without copying it,
+		* 'value' must outlive returned object. Copies of it own their characters. */
+		static JsonObject BorrowString(const char* value, unsigned int length);
+
 #pragma region UnaryOperators
 		/** Access an object value by name.
 		* 'key' must be null-terminated. */
 		const JsonObject& operator[](const char* key) const;
 		const JsonObject& operator[](const string& key) const;
+		const JsonObject& operator[](string_view key) const;
+		/** Access an object value by name hashed beforehand. */
+		const JsonObject& operator[](const JsonKey& key) const;
 
-		/** Access an object value by name.
+		/** Access an object value by name, adding it if missing.
 		* 'key' must be null-terminated. */
 		JsonObject& operator[](const char* key);
 		JsonObject& operator[](const string& key);
+		JsonObject& operator[](string_view key);
+		JsonObject& operator[](const JsonKey& key);
 
 		/** Access an array element by index.
-		* Returns 'NullSingleton' if out of range. */
+		* Returns 'NullSingleton' if out of range. Const access to packed array builds values of its elements once,
+		* shared by all readers until it is modified. Non-const access unpacks it. */
 		const JsonObject& operator[](int index) const;
 		JsonObject& operator[](int index);
+		/** Returns copy of array element at 'index', or null if out of range.
+		* Elements of packed arrays are read from their buffer, it is not unpacked. */
+		JsonObject GetElement(int index) const;
 #pragma endregion
 
 #pragma region BinaryOperator
@@ -79,13 +135,24 @@ namespace Json
 		bool operator==(const JsonObject& other) const;
 		/** Not Equal operator. */
 		bool operator!=(const JsonObject& other) const;
+
+		/** Returns 64-bit hash of the value, equal values have equal hashes.
+		* Object members are hashed regardless of their order. Hashes of objects and arrays are cached in them
+		* and compared first by 'operator==' when both are cached. Modifying any value drops the caches,
+		* including through references to values taken before hashing. Moving keeps the cache. */
+		uint64_t Hash() const;
 #pragma endregion
 
 #pragma region Iteration
-		using ObjectIterator = unordered_map<string, JsonObject>::iterator;
-		using ObjectConstIterator = unordered_map<string, JsonObject>::const_iterator;
-		using ArrayIterator = vector<JsonObject>::iterator;
-		using ArrayConstIterator = vector<JsonObject>::const_iterator;
+		// Containers are one block each, allocated from the default memory resource or from arena of 'JsonDocument'.
+		// Members are iterated in insertion order.
+		using MemberMap = JsonMemberMap<JsonObject>;
+		using ElementArray = JsonElementArray<JsonObject>;
+		using ObjectIterator = MemberMap::iterator;
+		using ObjectConstIterator = MemberMap::const_iterator;
+		using ArrayIterator = ElementArray::iterator;
+		/** Iterates elements of arrays, including packed ones without unpacking them. */
+		class ArrayConstIterator;
 
 		ObjectIterator ObjectBegin();
 		ObjectConstIterator ObjectConstBegin() const;
@@ -98,6 +165,10 @@ namespace Json
 		ArrayConstIterator ArrayConstEnd() const;
 #pragma endregion
 
+		/** Add or replace member of this object, 'key' may be borrowed.
+		* Returns reference to the member value. */
+		JsonObject& SetMember(JsonString&& key, JsonObject&& value);
+
 		/** Add value as a member to this array. */
 		void Append(const JsonObject& object);
 		/** Add value as a member to this array. */
@@ -105,7 +176,7 @@ namespace Json
 
 		/** Return number of values in object/array.
 		* Return 0 if this object is not object/array type. */
-		int Size() const;
+		inline int Size() const { return IsObject() || IsArray() ? static_cast<int>(length) : 0; }
 
 		/** Return true if object/array has no members, otherwise false. */
 		inline bool IsEmpty() const { return Size() == 0; }
@@ -113,6 +184,12 @@ namespace Json
 		/** Clears all members from object/array. */
 		void Clear();
 
+		/** Set string value, reusing owned buffer of current string value if it is large enough. */
+		void SetString(string_view value);
+
+		/** Reserve memory for 'newCapacity' array elements. */
+		void Reserve(unsigned int newCapacity);
+
 		/** Resize array size. */
 		void Resize(unsigned int newSize);
 
@@ -131,6 +208,7 @@ namespace Json
 		bool RemoveMember(const char* key, JsonObject* removed);
 		/** Remove member by specified key. */
 		bool RemoveMember(const string& key, JsonObject* removed);
+		bool RemoveMember(string_view key, JsonObject* removed);
 		
 		/** Remove element at specified index. */
 		bool RemoveIndex(int index, JsonObject* removed);
@@ -142,6 +220,8 @@ namespace Json
 		/** Return true if this object has member of specified key,
 		* otherwise false. */
 		bool IsMember(const string& key) const;
+		bool IsMember(string_view key) const;
+		bool IsMember(const JsonKey& key) const;
 
 		/** Returns names of all members of this object,
 		* Returns empty vector if this is not object type or
@@ -151,11 +231,27 @@ namespace Json
 		/** Getter for object type. */
 		inline ValueType GetType() const { return type; }
 
+		/** Return true if string value references characters it does not own. */
+		inline bool IsBorrowed() const { return (flags & borrowedFlag) != 0; }
+		/** Return true if number value is still its unconverted token, see 'JsonReader::SetLazyNumbers'. */
+		inline bool IsRawNumber() const { return (flags & rawFlag) != 0; }
+		/** Longest number token packed in the object, see 'RawToken'. */
+		static constexpr uint32_t rawInlineCapacity = 16;
+		/** Returns token of raw number, written into 'buffer' of 'rawInlineCapacity' characters if it is packed in this object. */
+		string_view RawToken(char* buffer) const;
+		/** Return true if array elements are stored as packed numbers, see 'JsonReader::SetPackedArrays'.
+		* They become 'JsonObject' values when accessed by non-const reference or iterator,
+		* or when a value of other type is added. Const access keeps them packed. */
+		inline bool IsPackedArray() const { return (flags & (packedIntFlag | packedDoubleFlag)) != 0; }
+
 #pragma region Conversion Checkers
-		bool IsIntegral(float value) const;
+		bool IsIntegral(double value) const;
 		bool IsInt() const;
 		bool IsUInt() const;
 		bool IsFloat() const;
+		bool IsInt64() const;
+		bool IsUInt64() const;
+		bool IsDouble() const;
 		bool IsNumeric() const;
 		inline bool IsNull() const { return GetType() == ValueType::Null; }
 		inline bool IsString() const { return GetType() == ValueType::String; }
@@ -167,48 +263,197 @@ namespace Json
 		
 #pragma region Converters
 		string AsString() const;
+		/** Returns characters of string value without copying,
+		* valid until this object is modified or destroyed. */
+		string_view AsStringView() const;
 		bool AsBool() const;
 		int AsInt() const;
 		unsigned int AsUInt() const;
 		float AsFloat() const;
+		int64_t AsInt64() const;
+		uint64_t AsUInt64() const;
+		double AsDouble() const;
 
 		bool AsString(string& value) const;
 		bool AsBool(bool& value) const;
 		bool AsInt(int& value) const;
 		bool AsUInt(unsigned int& value) const;
 		bool AsFloat(float& value) const;
+		bool AsInt64(int64_t& value) const;
+		bool AsUInt64(uint64_t& value) const;
+		bool AsDouble(double& value) const;
+
+		/** Returns elements of array packed as 64-bit integers without copying,
+		* empty if this is not such array. Valid until this array is modified or destroyed. */
+		JsonArrayView<int64_t> AsInt64Array() const;
+		/** Returns elements of array packed as doubles without copying,
+		* empty if this is not such array. Valid until this array is modified or destroyed. */
+		JsonArrayView<double> AsDoubleArray() const;
 #pragma endregion
 
 	private:
+		friend class JsonDomHandler;
+		friend class JsonQuery;
+
+		// Bits of 'flags'.
+		static constexpr uint8_t borrowedFlag = 1 << 0;
+		// Set on object members written by the current parse, see 'JsonDomHandler'.
+		static constexpr uint8_t visitedFlag = 1 << 1;
+		// Container is allocated in an arena and released with it, not by the destructor.
+		static constexpr uint8_t arenaFlag = 1 << 2;
+		// String characters are stored in '_value.Inline' instead of the heap.
+		static constexpr uint8_t inlineFlag = 1 << 3;
+		// Double value is kept as its number token and converted on each read, so it is written back as read.
+		// With 'inlineFlag' the token is packed in '_value.UInt64' 4 bits per character, see 'rawInlineCapacity',
+		// otherwise its characters are borrowed or on the heap like string ones.
+		static constexpr uint8_t rawFlag = 1 << 4;
+		// Array elements are numbers stored in '_value.Int64s' or '_value.Doubles' instead of 'JsonObject' values.
+		static constexpr uint8_t packedIntFlag = 1 << 5;
+		static constexpr uint8_t packedDoubleFlag = 1 << 6;
+		// Longest string stored inline, it is not null-terminated.
+		static constexpr uint32_t inlineCapacity = 8;
+
 		ValueType type;
+		uint8_t flags = 0;
+		// Size of owned heap string buffer, 0 if it does not fit or string is not on the heap.
+		uint16_t capacity = 0;
+		// Length of string value, or number of members/elements of object/array.
+		uint32_t length = 0;
 
 		union ValueHolder
 		{
-			constexpr ValueHolder() : Map(nullptr) {}
+			constexpr ValueHolder() : String(nullptr) {}
 			constexpr ValueHolder(bool Bool) : Bool(Bool) {}
 			constexpr ValueHolder(int Int) : Int(Int) {}
 			constexpr ValueHolder(unsigned int UInt) : UInt(UInt) {}
 			constexpr ValueHolder(float Float) : Float(Float) {}
+			constexpr ValueHolder(int64_t Int64) : Int64(Int64) {}
+			constexpr ValueHolder(uint64_t UInt64) : UInt64(UInt64) {}
+			constexpr ValueHolder(double Double) : Double(Double) {}
 
 			char* String;
+			char Inline[inlineCapacity];
 			bool Bool;
 			int Int;
 			unsigned int UInt;
 			float Float;
-			unordered_map<string, JsonObject>* Map;
-			vector<JsonObject>* Array;
+			int64_t Int64;
+			uint64_t UInt64;
+			double Double;
+			MemberMap Map;
+			ElementArray Array;
+			JsonElementArray<int64_t> Int64s;
+			JsonElementArray<double> Doubles;
 		} _value;
 
 	private:
+		/** Create empty object/array allocated in 'arena' with all its contents.
+		* Values added to it must own no heap memory, see 'JsonDocument'. */
+		static JsonObject ArenaContainer(ValueType type, std::pmr::memory_resource& arena);
+
+		/** Make this value Double kept as number 'token' until read, see 'rawFlag'.
+		* Short tokens are packed in the object, longer ones referenced if 'borrow' is true,
+		* otherwise copied, reusing heap buffer like 'SetString'. */
+		void SetRawNumber(string_view token, bool borrow);
+		/** Returns value of raw number, converted on each call. */
+		double RawNumberValue() const;
+		/** Store 'token' as raw number, see 'RawNumber'. */
+		void InitRawNumber(string_view token, bool borrow);
+
+		/** Make this value packed array of copies of 'values', reusing its packed buffer of the same type.
+		* Buffer is allocated in 'arena' unless it is nullptr. */
+		void SetPackedArray(const int64_t* values, size_t count, std::pmr::memory_resource* arena);
+		void SetPackedArray(const double* values, size_t count, std::pmr::memory_resource* arena);
+		/** Returns element of packed array as parsing it would have built it. */
+		JsonObject PackedElement(size_t index) const;
+		/** Return true if 'value' can be stored in this packed array and read back the same. */
+		bool PackedAccepts(const JsonObject& value) const;
+		/** Replace packed numbers of array with 'JsonObject' values, nothing is done if it is not packed. */
+		void Unpack();
+		/** Returns values of packed array elements for const access, built on first call from any thread.
+		* They are kept beside the buffer until 'ReleasePackedElements'. */
+		const JsonObject* PackedElements() const;
+		/** Free values built by 'PackedElements', called before packed array is modified or destroyed. */
+		void ReleasePackedElements();
+
+		/** Drop cached hashes, including ones of values holding this one, and values of packed elements.
+		* Called by everything that may modify this value or values in it. */
+		void Modified();
+		/** Return true and set 'hash' if hash of this object/array was cached in current 'generation'. */
+		bool CachedHash(uint64_t& hash, uint64_t generation) const;
+
 		/** Cleans up memory. */
 		void CleanUp();
+		/** Store number of members/elements in 'length', so 'Size' does not read the container.
+		* Packed arrays keep 'length' up to date themselves. */
+		inline void UpdateSize() { length = static_cast<uint32_t>(type == ValueType::Object ? _value.Map.size() : _value.Array.size()); }
+		/** Write 'value' over string or raw number, reusing owned heap buffer if it fits. */
+		bool ReuseText(string_view value);
 
 		// String Helpers.
-		/** 'value' must be null-terminated. */
+		/** Make this string value a copy of 'value', short strings are kept inline. */
+		void InitString(const char* value, uint32_t valueLength);
+		/** Returns characters of string value. */
+		inline const char* StringData() const { return (flags & inlineFlag) != 0 ? _value.Inline : _value.String; }
+		/** Returns null-terminated copy of 'value'. */
 		char* DublicateStringValue(const char* value, unsigned int length);
 		/** Free the string duplicated by DublicateStringValue() */
 		void ReleaseStringValue(char* value);
 	};
 }
 
+namespace Json
+{
+	/** Element a packed array iterator points to is read into the iterator,
+	* so references to it are valid until the iterator is advanced or destroyed. */
+	class JsonObject::ArrayConstIterator
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = JsonObject;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const JsonObject*;
+		using reference = const JsonObject&;
+
+		ArrayConstIterator() = default;
+		ArrayConstIterator(const JsonObject* array, size_t index) : array(array), index(index) {}
+
+		reference operator*() const
+		{
+			if (!array->IsPackedArray())
+				return array->_value.Array[index];
+			// Built in place, as assigning would count as modifying a value, see 'Hash'.
+			current.~JsonObject();
+			new (&current) JsonObject(array->PackedElement(index));
+			return current;
+		}
+		pointer operator->() const { return &**this; }
+
+		ArrayConstIterator& operator++() { ++index; return *this; }
+		ArrayConstIterator operator++(int) { ArrayConstIterator previous(array, index); ++index; return previous; }
+
+		bool operator==(const ArrayConstIterator& other) const { return array == other.array && index == other.index; }
+		bool operator!=(const ArrayConstIterator& other) const { return !(*this == other); }
+
+	private:
+		const JsonObject* array = nullptr;
+		size_t index = 0;
+		// Copy of packed element, numbers own no memory.
+		mutable JsonObject current;
+	};
+}
+
+namespace std
+{
+	/** Lets values be keys of hash containers, see 'JsonObject::Hash'. */
+	template<>
+	struct hash<Json::JsonObject>
+	{
+		size_t operator()(const Json::JsonObject& value) const
+		{
+			return static_cast<size_t>(value.Hash());
+		}
+	};
+}
+
 #endif // !JSON_OBJECT_H
@@ -0,0 +1,65 @@
+#ifndef JSON_PROJECTION_H
+#define JSON_PROJECTION_H
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "JsonString.h"
+
+using std::string;
+using std::string_view;
+using std::unordered_map;
+using std::vector;
+
+namespace Json
+{
+	/** Compiled set of paths selecting parts of a document for 'JsonReader'.
+	*	Paths are JSON Pointers ("/user/id", "/items/0/price") or dotted paths
+	*	("user.id", "items[*].price"). A '*' step matches any member or element,
+	*	exact names take precedence over it. An empty path selects the whole document.
+	*	Selected elements keep their index, skipped elements before them are built as null. */
+	class JsonProjection
+	{
+	public:
+		// Step of the paths, values reaching a 'selected' node are built whole.
+		struct Node
+		{
+			unordered_map<JsonString, size_t, JsonString::Hash> children;
+			size_t wildcard = noNode;
+			// One past the highest element index of 'children', elements below it are kept in place.
+			size_t elementCount = 0;
+			bool selected = false;
+		};
+
+		JsonProjection();
+
+		/** Add path to select. Returns false if it is malformed, see 'GetErrorMessage()'. */
+		bool AddPath(const string& path);
+		/** Remove all paths, nothing is selected. */
+		void Clear();
+
+		inline const Node* GetRoot() const { return &nodes.front(); }
+		/** Returns node for member 'name' of object at 'node', or nullptr if it is not selected. */
+		const Node* FindMember(const Node* node, string_view name) const;
+		/** Returns node for element 'index' of array at 'node', or nullptr if it is not selected. */
+		const Node* FindElement(const Node* node, size_t index) const;
+
+		/** Get Error message. */
+		inline const string& GetErrorMessage() const { return errorMessage; }
+
+	private:
+		static constexpr size_t noNode = static_cast<size_t>(-1);
+
+		/** Returns index of child node for 'step', creating it if needed. */
+		size_t AddStep(size_t node, const string& step);
+		bool SetError(const char* message, const string& path);
+
+	private:
+		// Root is the first node, children refer to nodes by index.
+		vector<Node> nodes;
+		string errorMessage;
+	};
+}
+
+#endif // !JSON_PROJECTION_H
@@ -0,0 +1,119 @@
+#ifndef JSON_PUSH_READER_H
+#define JSON_PUSH_READER_H
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "JsonObject.h"
+#include "JsonDomHandler.h"
+#include "JsonReader.h"
+
+using std::string;
+using std::vector;
+
+namespace Json
+{
+	/** Incremental JSON reader for input arriving in chunks.
+	*	Tokenizer state and the stack of open containers are kept between
+	*	'Feed' calls, only a token split by a chunk boundary is buffered. */
+	class JsonPushReader
+	{
+	public:
+		JsonPushReader() = default;
+		// Handler references 'root'.
+		JsonPushReader(const JsonPushReader&) = delete;
+		JsonPushReader& operator=(const JsonPushReader&) = delete;
+
+		/** Parse next chunk of JSON text.
+		* Returns false on syntax error, further chunks are ignored until 'Reset()'. */
+		bool Feed(const char* chunk, size_t length);
+		/** Signal end of input.
+		* Returns false if document is incomplete or invalid. */
+		bool Finish();
+		/** Prepare for a new document, keeps allocated buffers.
+		* Next document is written over the previous root, reusing its memory. */
+		void Reset();
+
+		/** Set how deep objects/arrays may nest, deeper documents fail to parse. */
+		inline void SetMaxDepth(size_t maxDepth) { this->maxDepth = maxDepth; }
+		/** Getter for maximum nesting depth. */
+		inline size_t GetMaxDepth() const { return maxDepth; }
+
+		/** Returns parsed document, complete after successful 'Finish()'. */
+		inline JsonObject& GetRoot() { return root; }
+
+		/** Get Error message. */
+		string GetErrorMessage() const;
+
+	private:
+		// What is accepted next.
+		enum class State : uint8_t
+		{
+			ExpectRoot,
+			ExpectValue,
+			ExpectFirstElementOrEnd,
+			ExpectFirstMemberOrEnd,
+			ExpectMemberName,
+			ExpectColon,
+			ExpectCommaOrEnd,
+			Done,
+			Error
+		};
+
+		// Kind of the token split by a chunk boundary.
+		enum class PartialToken : uint8_t
+		{
+			None,
+			String,
+			Scalar
+		};
+
+		// Open object/array and number of values read into it.
+		struct Frame
+		{
+			bool isObject;
+			size_t count;
+		};
+
+	private:
+		/** Handle '{', '}', '[', ']', ':' or ','. */
+		bool OnStructural(char c);
+		/** Handle complete string token including quotes. */
+		bool OnString(const char* start, const char* end);
+		/** Handle complete number/literal token. */
+		bool OnScalar(const char* start, const char* end);
+		/** Advance state after a complete value. */
+		void OnValue();
+
+		/** Returns closing quote of string body starting at 'current', or nullptr.
+		* 'escaped' carries whether the previous character was a backslash. */
+		const char* FindStringEnd(const char* current, const char* end, bool& escaped) const;
+		/** Returns end of number/literal starting at 'current'. */
+		const char* FindScalarEnd(const char* current, const char* end) const;
+
+		/** Set Error message. */
+		bool SetError(const char* message);
+
+	private:
+		State state = State::ExpectRoot;
+		vector<Frame> stack;
+		size_t maxDepth = JsonReader::defaultMaxDepth;
+		JsonObject root;
+		JsonDomHandler handler{ root };
+
+		PartialToken partialToken = PartialToken::None;
+		bool partialEscaped = false;
+		string partial;
+		// Scratch buffer for decoded strings.
+		string decodeBuffer;
+
+		// Bytes consumed before current chunk and position in it, for errors.
+		size_t consumed = 0;
+		const char* chunkBegin = nullptr;
+		const char* position = nullptr;
+
+		size_t errorOffset = 0;
+		string errorMessage;
+	};
+}
+
+#endif // !JSON_PUSH_READER_H
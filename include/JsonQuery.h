@@ -0,0 +1,200 @@
+#ifndef JSON_QUERY_H
+#define JSON_QUERY_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "JsonKey.h"
+#include "JsonObject.h"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace Json
+{
+	class JsonReader;
+
+	/** Compiled JSONPath or JSON Pointer, run against 'JsonObject' trees or JSON text.
+	*	JSONPath supports '$', '.name', '.*', "['name']", '[n]' (negative counts from the end),
+	*	'[*]' and filters '[?(@.path)]' / '[?(@.path op literal)]' with op one of
+	*	'==', '!=', '<', '<=', '>', '>=' and literal a number, quoted string, true, false or null.
+	*	JSON Pointers are RFC 6901 ("/orders/0/sku"), an empty pointer selects the root.
+	*	Member names are hashed when compiling, so running the query does not allocate. */
+	class JsonQuery
+	{
+	public:
+		/** Create query selecting nothing. */
+		JsonQuery() = default;
+		JsonQuery(const JsonQuery& other);
+		JsonQuery(JsonQuery&& other) noexcept = default;
+		JsonQuery& operator=(const JsonQuery& other);
+		JsonQuery& operator=(JsonQuery&& other) noexcept = default;
+
+		/** Compile JSONPath 'path', check 'IsValid' for errors. */
+		static JsonQuery Compile(string_view path);
+		/** Compile JSON Pointer 'pointer', check 'IsValid' for errors. */
+		static JsonQuery CompilePointer(string_view pointer);
+
+		/** Return true if query compiled, otherwise see 'GetErrorMessage()'. */
+		inline bool IsValid() const { return errorMessage.empty(); }
+		/** Get Error message. */
+		inline const string& GetErrorMessage() const { return errorMessage; }
+
+		/** Call 'visitor' with each value under 'root' the query selects, in document order.
+		* 'visitor' is bool(const JsonObject&), returning false stops the walk.
+		* Returns false if the walk was stopped. */
+		template<typename Visitor>
+		bool ForEach(const JsonObject& root, Visitor&& visitor) const;
+
+		/** Append values under 'root' the query selects to 'matches', returns number of them.
+		* Reusing 'matches' between runs avoids reallocating it. */
+		size_t Select(const JsonObject& root, vector<const JsonObject*>& matches) const;
+		/** Returns first value under 'root' the query selects, or nullptr. */
+		const JsonObject* SelectFirst(const JsonObject& root) const;
+
+		/** Run the query while 'reader' parses text from given begin to end, without building the document.
+		* Only selected values, and elements a filter is tested on, are built and given to 'onMatch',
+		* returning false from it stops parsing. Returns false if query is not valid, parsing failed or was stopped,
+		* see 'reader.GetErrorMessage()'. */
+		bool Stream(JsonReader& reader, const char* beginText, const char* endText,
+			const std::function<bool(const JsonObject&)>& onMatch) const;
+		bool Stream(JsonReader& reader, const string& json,
+			const std::function<bool(const JsonObject&)>& onMatch) const;
+
+	private:
+		enum class StepType : uint8_t
+		{
+			// Member by name, or element if name is an index of JSON Pointer.
+			Name,
+			// Element by index.
+			Index,
+			// Every member or element.
+			Wildcard,
+			// Every member or element passing the filter.
+			Filter
+		};
+
+		enum class FilterOperator : uint8_t
+		{
+			Exists,
+			Equal,
+			NotEqual,
+			Less,
+			LessEqual,
+			Greater,
+			GreaterEqual
+		};
+
+		struct Step
+		{
+			StepType type;
+			// Member name, characters are in 'names'.
+			JsonKey key = JsonKey(string_view());
+			uint32_t nameOffset = 0;
+			uint32_t nameLength = 0;
+			// Element index, negative counts from the end. 'noIndex' if name is not an index.
+			int64_t index = noIndex;
+			// Position in 'filters' of filter step.
+			size_t filter = 0;
+		};
+
+		struct Filter
+		{
+			// Steps from the tested value to the compared one, in 'filterSteps'.
+			size_t pathBegin;
+			size_t pathEnd;
+			FilterOperator op;
+			JsonObject literal;
+		};
+
+		class StreamHandler;
+
+		static constexpr int64_t noIndex = INT64_MIN;
+
+		/** Call 'visitor' with values selected by steps from 'step' on, starting at 'value'. */
+		template<typename Visitor>
+		bool Walk(const JsonObject& value, size_t step, Visitor& visitor) const;
+		/** Returns member or element selected by name or index 'step', or nullptr. */
+		static const JsonObject* Child(const JsonObject& value, const Step& step);
+		/** Return true if 'value' passes filter of 'step'. */
+		bool Matches(const JsonObject& value, const Step& step) const;
+
+		// Compiling.
+		bool ParsePath(string_view path, size_t& position, vector<Step>& parsedSteps, bool isRelative);
+		bool ParseFilter(string_view path, size_t& position);
+		bool ParseLiteral(string_view path, size_t& position, JsonObject& literal);
+		/** Parse quoted name at 'position', quote is either ' or ". */
+		bool ParseQuoted(string_view path, size_t& position, string& value);
+		/** Returns name step, 'name' is copied to 'names'. */
+		Step MakeName(string_view name, int64_t index);
+		/** Point keys of steps to 'names', after it is filled or copied. */
+		void BindKeys();
+		bool SetError(const char* message, string_view path);
+
+	private:
+		vector<Step> steps;
+		vector<Step> filterSteps;
+		vector<Filter> filters;
+		// Characters of all member names, keys of steps reference them.
+		vector<char> names;
+		string errorMessage;
+	};
+
+	template<typename Visitor>
+	bool JsonQuery::ForEach(const JsonObject& root, Visitor&& visitor) const
+	{
+		if (!IsValid())
+			return true;
+		return Walk(root, 0, visitor);
+	}
+
+	template<typename Visitor>
+	bool JsonQuery::Walk(const JsonObject& value, size_t step, Visitor& visitor) const
+	{
+		// Recursion is as deep as the query.
+		if (step == steps.size())
+			return visitor(value);
+
+		const Step& current = steps[step];
+		switch (current.type)
+		{
+		case StepType::Name:
+		case StepType::Index:
+		{
+			const JsonObject* child = Child(value, current);
+			return child == nullptr || Walk(*child, step + 1, visitor);
+		}
+		case StepType::Wildcard:
+		case StepType::Filter:
+		{
+			bool isFilter = current.type == StepType::Filter;
+			if (value.IsObject())
+			{
+				for (auto it = value.ObjectConstBegin(); it != value.ObjectConstEnd(); ++it)
+				{
+					if ((!isFilter || Matches(it->second, current)) && !Walk(it->second, step + 1, visitor))
+						return false;
+				}
+			}
+			else if (value.IsArray())
+			{
+				// Indexed, so elements of packed arrays are visited as values that stay, see 'Select'.
+				for (int i = 0; i < value.Size(); ++i)
+				{
+					const JsonObject& element = value[i];
+					if ((!isFilter || Matches(element, current)) && !Walk(element, step + 1, visitor))
+						return false;
+				}
+			}
+			return true;
+		}
+		default:
+			return true;
+		}
+	}
+}
+
+#endif // !JSON_QUERY_H
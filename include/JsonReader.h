@@ -1,29 +1,138 @@
 #ifndef JSON_READER_H
 #define JSON_READER_H
 #include <string>
+#include <string_view>
 #include <istream>
+#include <type_traits>
+#include <utility>
 #include "JsonObject.h"
+#include "JsonDomHandler.h"
+#include "JsonKeyTable.h"
+#include "JsonNumberParser.h"
+#include "JsonProjection.h"
+#include "JsonStructuralIndexer.h"
 
 using std::string;
+using std::string_view;
 using std::istream;
 
 namespace Json
 {
+	// Tokenization strategies of 'JsonReader'.
+	enum class ReaderMode : uint8_t
+	{
+		// Walk the text byte by byte.
+		Scalar,
+		// Build structural index with SIMD first, then jump from token to token.
+		Structural
+	};
+
+	// Whether 'Handler' accepts unconverted number tokens.
+	template<typename Handler, typename = void>
+	struct HasRawNumber : std::false_type {};
+	template<typename Handler>
+	struct HasRawNumber<Handler, std::void_t<decltype(std::declval<Handler&>().RawNumber(string_view()))>> : std::true_type {};
+
+	// Whether 'Handler' accepts whole arrays of numbers.
+	template<typename Handler, typename = void>
+	struct HasNumberArrays : std::false_type {};
+	template<typename Handler>
+	struct HasNumberArrays<Handler, std::void_t<
+		decltype(std::declval<Handler&>().Int64Array(static_cast<const int64_t*>(nullptr), size_t())),
+		decltype(std::declval<Handler&>().DoubleArray(static_cast<const double*>(nullptr), size_t()))>> : std::true_type {};
+
 	/** Class for Reading/Parsing JSON data from file/string to
 	*	'JsonObject' object. */
 	class JsonReader
 	{
 	public:
+		static constexpr size_t defaultMaxDepth = 1024;
+
+		/** Set tokenization strategy used by subsequent parses. */
+		inline void SetMode(ReaderMode mode) { this->mode = mode; }
+		/** Getter for tokenization strategy. */
+		inline ReaderMode GetMode() const { return mode; }
+		/** Set how deep objects/arrays may nest, deeper documents fail to parse. */
+		inline void SetMaxDepth(size_t maxDepth) { this->maxDepth = maxDepth; }
+		/** Getter for maximum nesting depth. */
+		inline size_t GetMaxDepth() const { return maxDepth; }
+		/** Set number of threads parsing large root arrays into 'JsonObject',
+		* 0 means one per hardware thread, 1 (default) parses on the calling thread only. */
+		inline void SetThreadCount(unsigned int threadCount) { this->threadCount = threadCount; }
+		/** Getter for number of parsing threads. */
+		inline unsigned int GetThreadCount() const { return threadCount; }
+		/** Build only the parts of documents selected by 'projection', skip the rest unparsed.
+		* Array elements before a selected index are built as null, so selected ones keep their index.
+		* nullptr (default) builds everything. 'projection' must outlive parsing. */
+		inline void SetProjection(const JsonProjection* projection) { this->projection = projection; }
+		/** Getter for projection. */
+		inline const JsonProjection* GetProjection() const { return projection; }
+		/** Keep real numbers of documents parsed into 'JsonObject' as their text, converted when first read.
+		* Such numbers are written back exactly as read. Integers that fit 64 bits are converted as usual. */
+		inline void SetLazyNumbers(bool lazyNumbers) { this->lazyNumbers = lazyNumbers; }
+		/** Getter for lazy numbers. */
+		inline bool GetLazyNumbers() const { return lazyNumbers; }
+		/** Store arrays holding only numbers of documents parsed into 'JsonObject' as packed
+		* 64-bit integers or doubles, see 'JsonObject::AsDoubleArray'. Only arrays of integers or of reals are packed,
+		* mixed ones are stored element by element. With lazy numbers set, only arrays of integers are packed. */
+		inline void SetPackedArrays(bool packedArrays) { this->packedArrays = packedArrays; }
+		/** Getter for packed arrays. */
+		inline bool GetPackedArrays() const { return packedArrays; }
+		/** Share member names of documents parsed into 'JsonObject' through 'keyTable',
+		* so repeated names are stored once. nullptr (default) copies each name.
+		* 'keyTable' must outlive the documents, parsing with it uses one thread. */
+		inline void SetKeyTable(JsonKeyTable* keyTable) { this->keyTable = keyTable; }
+		/** Getter for key table. */
+		inline JsonKeyTable* GetKeyTable() const { return keyTable; }
+		/** Returns bytes of the last parsed text skipped by projection. */
+		inline size_t GetBytesSkipped() const { return bytesSkipped; }
+		/** Returns bytes of the last parsed text that were parsed. */
+		inline size_t GetBytesBuilt() const { return static_cast<size_t>(end - begin) - bytesSkipped; }
+
 		/** Parse JSON text from 'std::string' class. */
 		bool Parse(const string& json, JsonObject& root);
 		/** Parse JSON text from input stream. */
 		bool Parse(istream& is, JsonObject& root);
-		/** Parse JSON text from given begin to end. */
+		/** Parse JSON text from given begin to end.
+		* Existing content of 'root' is overwritten in place, reusing its memory,
+		* so parsing similar documents into the same 'root' avoids reallocating it.
+		* 'root' is null if parsing fails. */
 		bool Parse(const char* beginText, const char* endText, JsonObject& root);
+		/** Parse JSON text from given begin to end in place.
+		* String values and member names of 'root' reference the text instead of copying it,
+		* escaped ones are decoded over their source, so the text is modified
+		* and must outlive 'root'. */
+		bool ParseInSitu(char* beginText, char* endText, JsonObject& root);
+		/** Parse JSON file by reading it directly from a memory mapping,
+		* without loading it into a separate buffer. */
+		bool ParseFile(const string& path, JsonObject& root);
+
+		/** Parse JSON text from given begin to end, reporting it to 'handler'
+		* as events instead of building 'JsonObject'. 'Handler' must provide:
+		*	bool Null(); bool Bool(bool); bool Int(int); bool UInt(unsigned int);
+		*	bool Int64(int64_t); bool UInt64(uint64_t); bool Double(double);
+		*	bool String(string_view); bool Key(string_view);
+		*	bool StartObject(); bool EndObject(size_t memberCount);
+		*	bool StartArray(); bool EndArray(size_t elementCount);
+		* Handler providing bool RawNumber(string_view) gets the tokens of numbers
+		* that are not converted when lazy numbers are set, see 'SetLazyNumbers'.
+		* Handler providing bool Int64Array(const int64_t*, size_t) and bool DoubleArray(const double*, size_t)
+		* gets arrays of numbers only whole when packed arrays are set, see 'SetPackedArrays'.
+		* Returning false from a handler method stops parsing.
+		* Views given to 'String'/'Key' are valid only during the call. */
+		template<typename Handler>
+		bool Parse(const char* beginText, const char* endText, Handler& handler);
+		/** Same as above, but strings are decoded in place,
+		* so views given to 'String'/'Key' are valid as long as the text is. */
+		template<typename Handler>
+		bool ParseInSitu(char* beginText, char* endText, Handler& handler);
 
 		/** Get Error message. */
 		string GetErrorMessage() const;
 
+		/** Drop state of the last parse, keeping allocated buffers for the next one. */
+		void Reset();
+
 	private:
 		enum class TokenType : uint8_t
 		{
@@ -55,27 +164,68 @@ namespace Json
 		{
 			Token token;
 			string message;
+			// Location is resolved eagerly if text is released right after parsing.
+			bool hasLocation = false;
+			int line;
+			int column;
+		};
+
+		// Open object/array and number of values read into it.
+		struct ContainerFrame
+		{
+			bool isObject;
+			size_t count;
+			// Index of the next element, counting skipped ones.
+			size_t index;
+			// Projection node of the container, nullptr if it is built whole.
+			const JsonProjection::Node* node;
 		};
 
 	private:
+		/** Set up text and structural index, check that root is object/array. */
+		bool BeginParse(const char* beginText, const char* endText);
+		/** Split root array at element boundaries and parse the pieces concurrently.
+		* Falls back to single threaded parse if root is not an array. */
+		bool ParseArrayInParallel(const char* beginText, const char* endText, JsonObject& root);
+		/** Parse comma separated values, which are part of a larger array, into array 'elements'. */
+		bool ParseElements(const char* beginText, const char* endText, JsonObject& elements);
+
 		bool ReadToken(Token& token);
-		bool ReadValue(JsonObject& object);
-		bool ReadValue(Token& token, JsonObject& object);
-		bool ReadObject(JsonObject& object);
-		bool ReadArray(JsonObject& object);
+		/** Read root value iteratively, open containers are kept in 'containerStack'. */
+		template<typename Handler>
+		bool ReadDocument(Handler& handler);
+		/** Decode member name and read the following colon. */
+		bool ReadMemberName(const Token& nameToken, string_view& name);
+		/** Read array following '[' at once if it holds only numbers fitting one packed type.
+		* Otherwise 'isRead' is false and reading is moved back to the first element. */
+		template<typename Handler>
+		bool ReadNumberArray(const Token& arrayBegin, Handler& handler, bool& isRead);
+		/** Report string, number or literal value. */
+		template<typename Handler>
+		bool ReadScalar(const Token& token, Handler& handler);
 		bool ReadString();
 		bool ReadNumber(TokenType& outType);
+		/** Move past value beginning with 'token' without decoding it. */
+		bool SkipValue(const Token& token);
 
-		bool DecodeString(const Token& token, JsonObject& object);
-		bool DecodeString(const Token& token, string& decodedText);
-		bool DecodeNumber(const Token& token, JsonObject& object);
+		/** 'decodedText' references the text if parsing in situ, otherwise 'decodeBuffer'. */
+		bool DecodeString(const Token& token, string_view& decodedText);
+		bool DecodeNumber(const Token& token, JsonNumberParser::Number& number);
+		template<typename Handler>
+		bool EmitNumber(const JsonNumberParser::Number& number, Handler& handler);
 
 		/** Set Error message. */
 		bool SetError(const char* message, const Token& token);
+		/** Set Error message for handler stopping the parse. */
+		bool SetStopped(const Token& token);
 
 		void GetLocationLineAndColumn(const char* location, int& line, int& column) const;
 
 		void SkipSpaces();
+		/** Move 'current' to the next entry of structural index. */
+		void SkipToNextStructural();
+		/** Returns true if 'c' can follow number/literal token. */
+		bool IsDelimiter(char c) const;
 		char GetNextChar();
 		bool Match(const char* pattern, int patternLength);
 
@@ -84,8 +234,330 @@ namespace Json
 		const char* current = 0;
 		const char* end = 0;
 
+		ReaderMode mode = ReaderMode::Scalar;
+		// Whether strings are decoded in place and borrowed by parsed objects.
+		bool inSitu = false;
+		bool lazyNumbers = false;
+		bool packedArrays = false;
+		// Whether text is array elements without brackets, see 'ParseElements'.
+		bool elementList = false;
+		unsigned int threadCount = 1;
+		const JsonProjection* projection = nullptr;
+		JsonKeyTable* keyTable = nullptr;
+		size_t bytesSkipped = 0;
+		// Scratch buffer for decoded strings.
+		string decodeBuffer;
+		// Scratch buffers for numbers of packed arrays.
+		vector<int64_t> packedIntegers;
+		vector<double> packedReals;
+		JsonStructuralIndexer indexer;
+		vector<uint32_t> structuralIndex;
+		size_t structuralPosition = 0;
+		size_t maxDepth = defaultMaxDepth;
+		// Kept between parses to reuse its memory.
+		vector<ContainerFrame> containerStack;
+		// Builds 'JsonObject' documents, kept to reuse its stack.
+		JsonDomHandler domHandler;
+
 		ErrorInfo errorInfo;
 	};
+
+	template<typename Handler>
+	bool JsonReader::Parse(const char* beginText, const char* endText, Handler& handler)
+	{
+		if (!BeginParse(beginText, endText))
+			return false;
+
+		return ReadDocument(handler);
+	}
+
+	template<typename Handler>
+	bool JsonReader::ParseInSitu(char* beginText, char* endText, Handler& handler)
+	{
+		inSitu = true;
+		bool succeed = Parse(static_cast<const char*>(beginText), static_cast<const char*>(endText), handler);
+		inSitu = false;
+		return succeed;
+	}
+
+	template<typename Handler>
+	bool JsonReader::ReadDocument(Handler& handler)
+	{
+		containerStack.clear();
+		Token token;
+		bool expectItem = elementList;
+		// Projection node of the next value, nullptr if it is built whole.
+		const JsonProjection::Node* valueNode = nullptr;
+		if (projection != nullptr && !projection->GetRoot()->selected)
+			valueNode = projection->GetRoot();
+		if (elementList)
+		{
+			// Text continues an array, whose elements end with the text.
+			token.type = TokenType::tokenArrayBegin;
+			token.start = token.end = current;
+			if (!handler.StartArray())
+				return SetStopped(token);
+			containerStack.push_back(ContainerFrame{ false, 0, 0, nullptr });
+		}
+		else if (!ReadToken(token))
+			return SetError("Syntax error: value, object or array expected.", token);
+
+		while (true)
+		{
+			if (!expectItem)
+			{
+				// 'token' begins a value.
+				bool isContainerBegin = token.type == TokenType::tokenObjectBegin || token.type == TokenType::tokenArrayBegin;
+				if (isContainerBegin)
+				{
+					if (containerStack.size() >= maxDepth)
+						return SetError("Maximum nesting depth exceeded.", token);
+
+					bool isObject = token.type == TokenType::tokenObjectBegin;
+					bool isRead = false;
+					if constexpr (HasNumberArrays<Handler>::value)
+					{
+						if (!isObject && packedArrays && valueNode == nullptr && !ReadNumberArray(token, handler, isRead))
+							return false; // Error already set.
+					}
+					if (isRead)
+					{
+						// Array of numbers was given whole, it is a completed value of its parent.
+						if (!containerStack.empty())
+							containerStack.back().count++;
+						isContainerBegin = false;
+					}
+					else
+					{
+						if (!(isObject ? handler.StartObject() : handler.StartArray()))
+							return SetStopped(token);
+						containerStack.push_back(ContainerFrame{ isObject, 0, 0, valueNode });
+					}
+				}
+				else
+				{
+					if (!ReadScalar(token, handler))
+						return false; // Error already set.
+					if (!containerStack.empty())
+						containerStack.back().count++;
+				}
+				expectItem = isContainerBegin;
+			}
+
+			// Find the next value, closing every container that ends before it.
+			while (true)
+			{
+				if (containerStack.empty())
+					return true;
+
+				ContainerFrame& frame = containerStack.back();
+				TokenType endType = frame.isObject ? TokenType::tokenObjectEnd : TokenType::tokenArrayEnd;
+				if (elementList && containerStack.size() == 1)
+					endType = TokenType::tokenEndOfStream;
+				Token next;
+				if (expectItem)
+				{
+					// After '{', '[' or ','.
+					if (!ReadToken(next))
+						return SetError(frame.isObject ? "Syntax error: Unexpected token." :
+							"Syntax error: value, object or array expected.", next);
+					if (next.type != endType)
+					{
+						Token first = next;
+						string_view name;
+						if (frame.isObject)
+						{
+							if (!ReadMemberName(first, name))
+								return false; // Error already set.
+							if (!ReadToken(next))
+								return SetError("Syntax error: value, object or array expected.", next);
+						}
+
+						valueNode = nullptr;
+						if (frame.node != nullptr)
+						{
+							// Only values on projection paths are built, others are skipped unparsed.
+							const JsonProjection::Node* child = frame.isObject ?
+								projection->FindMember(frame.node, name) : projection->FindElement(frame.node, frame.index++);
+							bool isContainerBegin = next.type == TokenType::tokenObjectBegin || next.type == TokenType::tokenArrayBegin;
+							if (child == nullptr || (!child->selected && !isContainerBegin))
+							{
+								if (!SkipValue(next))
+									return false; // Error already set.
+								bytesSkipped += current - first.start;
+								expectItem = false;
+								// Element before a selected index is kept in place as null.
+								if (!frame.isObject && frame.index <= frame.node->elementCount)
+								{
+									if (!handler.Null())
+										return SetStopped(first);
+									frame.count++;
+								}
+								continue;
+							}
+							valueNode = child->selected ? nullptr : child;
+						}
+
+						if (frame.isObject && !handler.Key(name))
+							return SetStopped(first);
+						token = next;
+						expectItem = false;
+						break;
+					}
+				}
+				else
+				{
+					// Check for comma.
+					if (!ReadToken(next) || (next.type != TokenType::tokenComma && next.type != endType))
+						return SetError(frame.isObject ? "Missing ',' or '}' after object member value." :
+							"Missing ',' or ']' after array value.", next);
+					if (next.type == TokenType::tokenComma)
+					{
+						expectItem = true;
+						continue;
+					}
+				}
+
+				// Container ended, it is a completed value of its parent.
+				bool isObject = frame.isObject;
+				size_t count = frame.count;
+				containerStack.pop_back();
+				if (!(isObject ? handler.EndObject(count) : handler.EndArray(count)))
+					return SetStopped(next);
+				if (!containerStack.empty())
+					containerStack.back().count++;
+				expectItem = false;
+			}
+		}
+	}
+
+	template<typename Handler>
+	bool JsonReader::ReadNumberArray(const Token& arrayBegin, Handler& handler, bool& isRead)
+	{
+		isRead = false;
+		const char* firstElement = current;
+		size_t firstPosition = structuralPosition;
+		packedIntegers.clear();
+		packedReals.clear();
+		bool isReal = false;
+		Token token;
+		while (ReadToken(token) && (token.type == TokenType::tokenInteger || token.type == TokenType::tokenReal))
+		{
+			// Only arrays of integers or of reals are packed, so elements keep their type.
+			if (packedIntegers.empty() && packedReals.empty())
+				isReal = token.type == TokenType::tokenReal;
+			else if (isReal != (token.type == TokenType::tokenReal))
+				break;
+			// Lazy reals must keep their text, so they are not packed.
+			if (isReal && lazyNumbers)
+				break;
+			JsonNumberParser::Number number;
+			if (!JsonNumberParser::Parse(token.start, token.end, number))
+				break;
+			if (isReal)
+				packedReals.push_back(number.Double);
+			else
+			{
+				bool isSigned = number.type == ValueType::Int || number.type == ValueType::Int64;
+				if (number.type == ValueType::Double || (!isSigned && number.UInt64 > static_cast<uint64_t>(INT64_MAX)))
+					break;
+				packedIntegers.push_back(isSigned ? number.Int64 : static_cast<int64_t>(number.UInt64));
+			}
+
+			if (!ReadToken(token) || (token.type != TokenType::tokenComma && token.type != TokenType::tokenArrayEnd))
+				break;
+			if (token.type == TokenType::tokenArrayEnd)
+			{
+				isRead = true;
+				break;
+			}
+		}
+
+		if (!isRead)
+		{
+			// Read it again element by element, which also reports errors.
+			current = firstElement;
+			structuralPosition = firstPosition;
+			return true;
+		}
+		bool accepted = isReal ? handler.DoubleArray(packedReals.data(), packedReals.size()) :
+			handler.Int64Array(packedIntegers.data(), packedIntegers.size());
+		return accepted || SetStopped(arrayBegin);
+	}
+
+	template<typename Handler>
+	bool JsonReader::ReadScalar(const Token& token, Handler& handler)
+	{
+		switch (token.type)
+		{
+		case TokenType::tokenString:
+		{
+			string_view value;
+			if (!DecodeString(token, value))
+				return false; // Error already set.
+			return handler.String(value) || SetStopped(token);
+		}
+		case TokenType::tokenInteger:
+		case TokenType::tokenReal:
+		{
+			JsonNumberParser::Number number;
+			if constexpr (HasRawNumber<Handler>::value)
+			{
+				if (lazyNumbers)
+				{
+					// Reals are only validated, their token is kept unconverted.
+					if (token.type == TokenType::tokenReal)
+					{
+						if (!JsonNumberParser::IsValid(token.start, token.end))
+							return SetError("Invalid number.", token);
+						return handler.RawNumber(string_view(token.start, token.end - token.start)) || SetStopped(token);
+					}
+					if (!JsonNumberParser::ParseInteger(token.start, token.end, number))
+						return SetError("Invalid number.", token);
+					if (number.type == ValueType::Double)
+						return handler.RawNumber(string_view(token.start, token.end - token.start)) || SetStopped(token);
+					return EmitNumber(number, handler) || SetStopped(token);
+				}
+			}
+			if (!DecodeNumber(token, number))
+				return false; // Error already set.
+			return EmitNumber(number, handler) || SetStopped(token);
+		}
+		case TokenType::tokenTrue:
+			return handler.Bool(true) || SetStopped(token);
+		case TokenType::tokenFalse:
+			return handler.Bool(false) || SetStopped(token);
+		case TokenType::tokenNull:
+			return handler.Null() || SetStopped(token);
+			// Unexpected Tokens.
+		case TokenType::tokenComma:
+		case TokenType::tokenColon:
+		case TokenType::tokenObjectEnd:
+		case TokenType::tokenArrayEnd:
+		case TokenType::tokenError:
+		default:
+			return SetError("Syntax error: Unexpected token.", token);
+		}
+	}
+
+	template<typename Handler>
+	bool JsonReader::EmitNumber(const JsonNumberParser::Number& number, Handler& handler)
+	{
+		switch (number.type)
+		{
+		case ValueType::Int:
+			return handler.Int(static_cast<int>(number.Int64));
+		case ValueType::UInt:
+			return handler.UInt(static_cast<unsigned int>(number.UInt64));
+		case ValueType::Int64:
+			return handler.Int64(number.Int64);
+		case ValueType::UInt64:
+			return handler.UInt64(number.UInt64);
+		case ValueType::Double:
+		default:
+			return handler.Double(number.Double);
+		}
+	}
 }
 
 #endif // !JSON_READER_H
@@ -0,0 +1,67 @@
+#ifndef JSON_STRING_H
+#define JSON_STRING_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+using std::string;
+using std::string_view;
+
+namespace Json
+{
+	/** Length-carrying string used as object member name.
+	*	Either owns a heap copy of its characters or borrows
+	*	characters from a buffer that outlives it (in-situ parsing). */
+	class JsonString
+	{
+	public:
+		struct Hash
+		{
+			inline size_t operator()(const JsonString& str) const { return std::hash<string_view>()(str.View()); }
+		};
+
+		/** Create empty string. */
+		constexpr JsonString()
+			: data(""), length(0), owned(false) {}
+		/** Create string owning a copy of 'value'. */
+		JsonString(const char* value, size_t length);
+		JsonString(const string& value);
+		JsonString(const JsonString& other);
+		JsonString(JsonString&& other) noexcept;
+		~JsonString();
+
+		/** Create string referencing 'value' without copying,
+		* 'value' must outlive the returned string. */
+		static JsonString Borrow(const char* value, size_t length);
+
+		JsonString& operator=(const JsonString& other);
+		JsonString& operator=(JsonString&& other) noexcept;
+
+		inline bool operator==(const JsonString& other) const { return Equals(other.View()); }
+		inline bool operator!=(const JsonString& other) const { return !(*this == other); }
+
+		/** Returns pointer to characters, it may not be null-terminated. */
+		inline const char* Data() const { return data; }
+		inline size_t Length() const { return length; }
+		inline string_view View() const { return string_view(data, length); }
+		inline string ToString() const { return string(data, length); }
+		/** Compare characters with 'other', names shared through 'JsonKeyTable' match by pointer. */
+		inline bool Equals(string_view other) const
+		{
+			return length == other.length() && (data == other.data() || View() == other);
+		}
+		/** Returns true if characters are referenced, not owned. */
+		inline bool IsBorrowed() const { return !owned; }
+
+	private:
+		/** Release owned characters. */
+		void CleanUp();
+
+	private:
+		const char* data;
+		uint32_t length;
+		bool owned;
+	};
+}
+
+#endif // !JSON_STRING_H
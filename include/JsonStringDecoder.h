@@ -0,0 +1,26 @@
+#ifndef JSON_STRING_DECODER_H
+#define JSON_STRING_DECODER_H
+#include <string>
+
+using std::string;
+
+namespace Json
+{
+	/** Validates and decodes JSON string bodies (text between the quotes) in one pass.
+	*	Escape sequences, including \uXXXX with surrogate pairs, are decoded to UTF-8,
+	*	raw bytes must be valid UTF-8 without control characters. */
+	class JsonStringDecoder
+	{
+	public:
+		/** Decode [begin, end) and append result to 'decoded'.
+		* Returns false if string has invalid escape sequence or character. */
+		static bool Decode(const char* begin, const char* end, string& decoded);
+
+		/** Decode [begin, end) in place, decoded text is never longer than source.
+		* 'decodedEnd' receives end of decoded text, it is 'end' if there was nothing to decode.
+		* Returns false if string has invalid escape sequence or character. */
+		static bool DecodeInSitu(char* begin, char* end, char*& decodedEnd);
+	};
+}
+
+#endif // !JSON_STRING_DECODER_H
@@ -0,0 +1,56 @@
+#ifndef JSON_STRUCTURAL_INDEXER_H
+#define JSON_STRUCTURAL_INDEXER_H
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+using std::vector;
+
+namespace Json
+{
+	// Instruction sets the structural indexer can run on.
+	enum class SimdLevel : uint8_t
+	{
+		Scalar,
+		SSE42,
+		AVX2
+	};
+
+	/** First stage of the structural reader mode.
+	*	Scans JSON text 64 bytes at a time and records the offset of every
+	*	structural character ('{', '}', '[', ']', ':', ','), every unescaped quote
+	*	and the first byte of every number/literal that is not inside a string. */
+	class JsonStructuralIndexer
+	{
+	public:
+		/** Returns the best instruction set supported by the running CPU. */
+		static SimdLevel DetectSimdLevel();
+
+		/** Create indexer that uses the best supported instruction set. */
+		JsonStructuralIndexer();
+		/** Create indexer that uses given instruction set,
+		* falls back to the best supported one if 'level' is not available. */
+		explicit JsonStructuralIndexer(SimdLevel level);
+
+		/** Fill 'positions' with offsets (from 'begin') of all structural characters.
+		* Returns false if text is too large to be indexed with 32-bit offsets. */
+		bool Index(const char* begin, const char* end, vector<uint32_t>& positions) const;
+
+		/** Split elements of the root array in [begin, end) into pieces of about 'pieceSize' bytes.
+		* 'onPiece' gets offsets (from 'begin') of each piece as soon as it is found,
+		* pieces exclude the brackets and the commas between them. Text is indexed
+		* window by window, so it may be larger than 32-bit offsets allow.
+		* Returns false if root is not an array or it is not closed. */
+		bool SplitArray(const char* begin, const char* end, size_t pieceSize,
+			const std::function<void(size_t pieceBegin, size_t pieceEnd)>& onPiece) const;
+
+		/** Getter for used instruction set. */
+		inline SimdLevel GetSimdLevel() const { return level; }
+
+	private:
+		SimdLevel level;
+	};
+}
+
+#endif // !JSON_STRUCTURAL_INDEXER_H
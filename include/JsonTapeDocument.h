@@ -0,0 +1,180 @@
+#ifndef JSON_TAPE_DOCUMENT_H
+#define JSON_TAPE_DOCUMENT_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "JsonObject.h"
+
+using std::string;
+using std::string_view;
+using std::vector;
+
+namespace Json
+{
+	class JsonTapeDocument;
+
+	/** Read-only view of a value in 'JsonTapeDocument', cheap to copy.
+	*	Valid until the document is parsed again or destroyed.
+	*	Mirrors read access of 'JsonObject'. */
+	class JsonTapeValue
+	{
+	public:
+		/** Iterates elements of array or members of object in document order. */
+		class Iterator
+		{
+		public:
+			/** Element or member value. */
+			JsonTapeValue operator*() const;
+			/** Member name, empty for array elements. */
+			string_view GetName() const;
+			Iterator& operator++();
+
+			inline bool operator==(const Iterator& other) const { return index == other.index; }
+			inline bool operator!=(const Iterator& other) const { return index != other.index; }
+
+		private:
+			friend class JsonTapeValue;
+			Iterator(const JsonTapeDocument* document, size_t index, bool members)
+				: document(document), index(index), members(members) {}
+
+		private:
+			const JsonTapeDocument* document;
+			// Tape index of the element, or of the member name.
+			size_t index;
+			bool members;
+		};
+
+		/** Create missing value, it behaves like null. */
+		JsonTapeValue() = default;
+
+#pragma region UnaryOperators
+		/** Access an object value by name.
+		* Returns missing value if there is no such member or this is not object. */
+		JsonTapeValue operator[](const char* key) const;
+		JsonTapeValue operator[](const string& key) const;
+
+		/** Access an array element by index.
+		* Returns missing value if out of range or this is not array. */
+		JsonTapeValue operator[](int index) const;
+#pragma endregion
+
+#pragma region Iteration
+		/** Iterators are empty if this value is not of the iterated type. */
+		Iterator ObjectBegin() const;
+		Iterator ObjectEnd() const;
+		Iterator ArrayBegin() const;
+		Iterator ArrayEnd() const;
+#pragma endregion
+
+		/** Return true if this object has member of specified key, otherwise false. */
+		bool IsMember(const char* key) const;
+		bool IsMember(const string& key) const;
+
+		/** Return number of values in object/array.
+		* Return 0 if this value is not object/array type. */
+		int Size() const;
+
+		/** Return true if value exists in the document. */
+		inline bool IsValid() const { return document != nullptr; }
+
+		/** Getter for value type. */
+		ValueType GetType() const;
+
+#pragma region Conversion Checkers
+		bool IsNumeric() const;
+		inline bool IsNull() const { return GetType() == ValueType::Null; }
+		inline bool IsString() const { return GetType() == ValueType::String; }
+		inline bool IsBool() const { return GetType() == ValueType::Bool; }
+		inline bool IsObject() const { return GetType() == ValueType::Object; }
+		inline bool IsArray() const { return GetType() == ValueType::Array; }
+#pragma endregion
+
+#pragma region Converters
+		string AsString() const;
+		/** Returns characters of string value without copying,
+		* valid as long as the value. Empty if this is not string. */
+		string_view AsStringView() const;
+		bool AsBool() const;
+		int AsInt() const;
+		unsigned int AsUInt() const;
+		float AsFloat() const;
+		int64_t AsInt64() const;
+		uint64_t AsUInt64() const;
+		double AsDouble() const;
+
+		bool AsString(string& value) const;
+		bool AsBool(bool& value) const;
+		bool AsInt(int& value) const;
+		bool AsUInt(unsigned int& value) const;
+		bool AsFloat(float& value) const;
+		bool AsInt64(int64_t& value) const;
+		bool AsUInt64(uint64_t& value) const;
+		bool AsDouble(double& value) const;
+#pragma endregion
+
+		/** Build this value and everything in it into 'object'.
+		* Returns false if this value is missing. */
+		bool ToObject(JsonObject& object) const;
+
+	private:
+		friend class JsonTapeDocument;
+		JsonTapeValue(const JsonTapeDocument* document, size_t index)
+			: document(document), index(index) {}
+
+		JsonTapeValue FindMember(const char* key, size_t keyLength) const;
+		/** Returns string, number or literal value as 'JsonObject', strings are borrowed.
+		* Returns null for containers and missing values. */
+		JsonObject ToScalar() const;
+
+	private:
+		const JsonTapeDocument* document = nullptr;
+		// Tape index of the value.
+		size_t index = 0;
+	};
+
+	/** Immutable document stored as one contiguous tape of 64-bit entries plus a string buffer,
+	*	instead of a tree of separately allocated nodes, so it is cheap to traverse and to destroy.
+	*	Objects and arrays record the index of their end entry, so a subtree is skipped in O(1).
+	*	Convert to 'JsonObject' for code that needs to modify the document. */
+	class JsonTapeDocument
+	{
+	public:
+		/** Parse JSON text from given begin to end, the text is not referenced afterwards. */
+		bool Parse(const char* beginText, const char* endText);
+		/** Parse JSON text from 'std::string' class. */
+		bool Parse(const string& json);
+
+		/** Replace document with a copy of 'object'. */
+		void FromObject(const JsonObject& object);
+		/** Build 'JsonObject' tree of the whole document. */
+		inline bool ToObject(JsonObject& object) const { return GetRoot().ToObject(object); }
+
+		/** Remove document, keeps allocated memory. */
+		void Clear();
+
+		/** Getter for root value, missing if nothing is parsed. */
+		inline JsonTapeValue GetRoot() const { return tape.empty() ? JsonTapeValue() : JsonTapeValue(this, 0); }
+
+		/** Access root object value by name. */
+		inline JsonTapeValue operator[](const char* key) const { return GetRoot()[key]; }
+		inline JsonTapeValue operator[](const string& key) const { return GetRoot()[key]; }
+		/** Access root array element by index. */
+		inline JsonTapeValue operator[](int index) const { return GetRoot()[index]; }
+
+		/** Get Error message. */
+		inline const string& GetErrorMessage() const { return errorMessage; }
+
+	private:
+		friend class JsonTapeValue;
+		/** Appends values to the tape, see the source file for the entry layout. */
+		class Builder;
+
+		vector<uint64_t> tape;
+		// Strings and member names, each prefixed by its 32-bit length and followed by '\0'.
+		string strings;
+		string errorMessage;
+	};
+}
+
+#endif // !JSON_TAPE_DOCUMENT_H
@@ -25,10 +25,14 @@ namespace Json
 		bool WriteArray(string& json, const JsonObject& object);
 		bool WriteStyledObject(string& json, const JsonObject& object, int deepLevel);
 		bool WriteStyledArray(string& json, const JsonObject& object, int deepLevel);
+		/** Write array of packed numbers on one line, see 'JsonObject::IsPackedArray'. */
+		bool WritePackedArray(string& json, const JsonObject& object);
 
 		/** Add quots to string. */
 		string ToQuoticString(const string& str);
 		string&& ToQuoticString(string&& str);
+		/** Append 'str' to 'json' with escaped quotes, backslashes and control characters. */
+		void AppendEscaped(string& json, const string& str);
 
 		/** Returns string of tabs depending on deep level. */
 		string GetIndent(int deepLevel);
@@ -0,0 +1,143 @@
+#include "JsonArena.h"
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace Json
+{
+	namespace
+	{
+		inline char* AlignUp(char* pointer, size_t alignment)
+		{
+			uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+			return reinterpret_cast<char*>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+		}
+
+		inline size_t RoundUp(size_t size, size_t multiple)
+		{
+			return (size + multiple - 1) / multiple * multiple;
+		}
+	}
+
+	JsonArena::JsonArena(size_t chunkSize, bool useHugePages)
+		: chunkSize(chunkSize), useHugePages(useHugePages)
+	{
+	}
+
+	JsonArena::~JsonArena()
+	{
+		for (const Chunk& chunk : chunks)
+			FreeChunk(chunk);
+	}
+
+	void JsonArena::Release()
+	{
+		if (chunks.empty())
+			return;
+
+		size_t keep = chunks.front().isDedicated ? 0 : 1;
+		for (size_t i = keep; i < chunks.size(); ++i)
+			FreeChunk(chunks[i]);
+		chunks.resize(keep);
+
+		current = keep != 0 ? chunks.front().data : nullptr;
+		chunkEnd = keep != 0 ? current + chunks.front().size : nullptr;
+	}
+
+	size_t JsonArena::GetBytesReserved() const
+	{
+		size_t total = 0;
+		for (const Chunk& chunk : chunks)
+			total += chunk.size;
+		return total;
+	}
+
+	void* JsonArena::do_allocate(size_t bytes, size_t alignment)
+	{
+		char* aligned = AlignUp(current, alignment);
+		if (current == nullptr || aligned > chunkEnd || bytes > static_cast<size_t>(chunkEnd - aligned))
+		{
+			// Oversized allocation gets its own chunk, current one stays for smaller ones.
+			if (bytes + alignment > chunkSize)
+				return AlignUp(AddChunk(bytes + alignment, true), alignment);
+			aligned = AlignUp(AddChunk(chunkSize, false), alignment);
+		}
+		current = aligned + bytes;
+		return aligned;
+	}
+
+	char* JsonArena::AddChunk(size_t size, bool isDedicated)
+	{
+		Chunk chunk{ nullptr, size, false, isDedicated };
+#ifdef _WIN32
+		if (useHugePages)
+		{
+			// Needs "Lock pages in memory" privilege, heap is used without it.
+			size_t largePageSize = GetLargePageMinimum();
+			if (largePageSize != 0)
+			{
+				size_t mappedSize = RoundUp(size, largePageSize);
+				void* data = VirtualAlloc(nullptr, mappedSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+				if (data != nullptr)
+					chunk = Chunk{ static_cast<char*>(data), mappedSize, true, isDedicated };
+			}
+		}
+#else
+		if (useHugePages)
+		{
+			// Explicit huge pages are often not reserved, transparent ones are requested then.
+			constexpr size_t hugePageSize = 2 << 20;
+			size_t mappedSize = RoundUp(size, hugePageSize);
+			void* data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+			data = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+			if (data == MAP_FAILED)
+			{
+				data = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+#ifdef MADV_HUGEPAGE
+				if (data != MAP_FAILED)
+					madvise(data, mappedSize, MADV_HUGEPAGE);
+#endif
+			}
+			if (data != MAP_FAILED)
+				chunk = Chunk{ static_cast<char*>(data), mappedSize, true, isDedicated };
+		}
+#endif
+		if (chunk.data == nullptr)
+		{
+			chunk.data = static_cast<char*>(malloc(size));
+			if (chunk.data == nullptr)
+				throw std::bad_alloc();
+		}
+
+		chunks.push_back(chunk);
+		if (!isDedicated)
+		{
+			current = chunk.data;
+			chunkEnd = chunk.data + chunk.size;
+		}
+		return chunk.data;
+	}
+
+	void JsonArena::FreeChunk(const Chunk& chunk)
+	{
+		if (!chunk.isMapped)
+		{
+			free(chunk.data);
+			return;
+		}
+#ifdef _WIN32
+		VirtualFree(chunk.data, 0, MEM_RELEASE);
+#else
+		munmap(chunk.data, chunk.size);
+#endif
+	}
+}
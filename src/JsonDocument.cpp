@@ -0,0 +1,35 @@
+#include "JsonDocument.h"
+
+namespace Json
+{
+	JsonDocument::JsonDocument(size_t chunkSize, bool useHugePages)
+		: arena(chunkSize, useHugePages)
+	{
+		handler.SetArena(&arena);
+	}
+
+	bool JsonDocument::Parse(const char* beginText, const char* endText)
+	{
+		Clear();
+		handler.Reset(root);
+		handler.SetKeyTable(reader.GetKeyTable());
+		if (reader.Parse(beginText, endText, handler))
+			return true;
+
+		Clear();
+		return false;
+	}
+
+	bool JsonDocument::Parse(const string& json)
+	{
+		return Parse(json.c_str(), json.c_str() + json.length());
+	}
+
+	void JsonDocument::Clear()
+	{
+		// Arena values are not freed one by one, the arena is.
+		root = JsonObject();
+		handler.Reset();
+		arena.Release();
+	}
+}
@@ -0,0 +1,266 @@
+#include "JsonDomHandler.h"
+#include <cstring>
+
+namespace Json
+{
+	JsonDomHandler::JsonDomHandler(JsonObject& root, bool borrowStrings)
+		: root(&root), borrowStrings(borrowStrings)
+	{
+	}
+
+	bool JsonDomHandler::Null()
+	{
+		JsonObject& value = NextValue();
+		value = JsonObject();
+		MarkVisited(value);
+		return true;
+	}
+
+	bool JsonDomHandler::Bool(bool value)
+	{
+		JsonObject& target = NextValue();
+		target = JsonObject(value);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::Int(int value)
+	{
+		JsonObject& target = NextValue();
+		target = JsonObject(value);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::UInt(unsigned int value)
+	{
+		JsonObject& target = NextValue();
+		target = JsonObject(value);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::Int64(int64_t value)
+	{
+		JsonObject& target = NextValue();
+		target = JsonObject(value);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::UInt64(uint64_t value)
+	{
+		JsonObject& target = NextValue();
+		target = JsonObject(value);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::Double(double value)
+	{
+		JsonObject& target = NextValue();
+		target = JsonObject(value);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::String(string_view value)
+	{
+		JsonObject& target = NextValue();
+		if (borrowStrings)
+			target = JsonObject::BorrowString(value.data(), static_cast<unsigned int>(value.length()));
+		else if (arena != nullptr && value.length() > JsonObject::inlineCapacity)
+			target = JsonObject::BorrowString(CopyToArena(value), static_cast<unsigned int>(value.length()));
+		else if (arena != nullptr)
+			target = JsonObject(value);
+		else
+			target.SetString(value);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::RawNumber(string_view token)
+	{
+		JsonObject& target = NextValue();
+		// Short tokens are packed in the value, longer ones are borrowed or copied like strings.
+		if (arena != nullptr && token.length() > JsonObject::rawInlineCapacity)
+			target.SetRawNumber(string_view(CopyToArena(token), token.length()), true);
+		else
+			target.SetRawNumber(token, borrowStrings);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::Int64Array(const int64_t* values, size_t count)
+	{
+		JsonObject& target = NextValue();
+		target.SetPackedArray(values, count, arena);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::DoubleArray(const double* values, size_t count)
+	{
+		JsonObject& target = NextValue();
+		target.SetPackedArray(values, count, arena);
+		MarkVisited(target);
+		return true;
+	}
+
+	bool JsonDomHandler::Key(string_view key)
+	{
+		Frame& frame = stack.back();
+		JsonObject::MemberMap& members = frame.container->_value.Map;
+		auto it = members.find(key);
+		if (it == members.end())
+			it = members.emplace(MakeName(key), JsonObject()).first;
+
+		// Members are kept in the order of the current text, a repeated name keeps its first place.
+		size_t position = it - members.begin();
+		if (position >= frame.index)
+		{
+			members.relocate(position, frame.index);
+			it = members.begin() + frame.index++;
+		}
+		else if (keyTable != nullptr)
+		{
+			// Name may come from before the table was set.
+			string_view name = keyTable->Intern(key);
+			if (it->first.Data() != name.data())
+				it->first = JsonString::Borrow(name.data(), name.length());
+		}
+		else if (it->first.IsBorrowed() && it->first.Data() != key.data() && arena == nullptr)
+		{
+			// Name borrowed from previous text, point it to the current one. Names copied to arena stay valid.
+			it->first = MakeName(key);
+		}
+		memberValue = &it->second;
+		return true;
+	}
+
+	bool JsonDomHandler::StartObject()
+	{
+		JsonObject& target = NextValue();
+		if (!target.IsObject())
+			target = arena != nullptr ? JsonObject::ArenaContainer(ValueType::Object, *arena) : JsonObject(ValueType::Object);
+		// Reused container is filled without its setters, so its cached hash is dropped here.
+		target.Modified();
+		MarkVisited(target);
+		stack.push_back(Frame{ &target, 0 });
+		return true;
+	}
+
+	bool JsonDomHandler::EndObject(size_t /*memberCount*/)
+	{
+		// Remove members left from previous document, unmark the others.
+		JsonObject& container = *stack.back().container;
+		container._value.Map.erase_if([](JsonObject::MemberMap::value_type& member)
+		{
+			if ((member.second.flags & JsonObject::visitedFlag) == 0)
+				return true;
+			member.second.flags &= ~JsonObject::visitedFlag;
+			return false;
+		});
+		container.UpdateSize();
+		stack.pop_back();
+		return true;
+	}
+
+	bool JsonDomHandler::StartArray()
+	{
+		JsonObject& target = NextValue();
+		if (!target.IsArray() || target.IsPackedArray())
+			target = arena != nullptr ? JsonObject::ArenaContainer(ValueType::Array, *arena) : JsonObject(ValueType::Array);
+		target.Modified();
+		MarkVisited(target);
+		stack.push_back(Frame{ &target, 0 });
+		return true;
+	}
+
+	bool JsonDomHandler::EndArray(size_t /*elementCount*/)
+	{
+		// Remove elements left from previous document.
+		JsonObject& container = *stack.back().container;
+		container._value.Array.erase(container._value.Array.begin() + stack.back().index, container._value.Array.end());
+		container.UpdateSize();
+		stack.pop_back();
+		return true;
+	}
+
+	void JsonDomHandler::Reset()
+	{
+		stack.clear();
+		memberValue = nullptr;
+	}
+
+	void JsonDomHandler::Reset(JsonObject& root, bool borrowStrings)
+	{
+		Reset();
+		this->root = &root;
+		this->borrowStrings = borrowStrings;
+		// Previous content may borrow text released by now, so it is not reused.
+		if (borrowStrings)
+			root = JsonObject();
+	}
+
+	void JsonDomHandler::Discard()
+	{
+		Reset();
+		if (root != nullptr)
+			*root = JsonObject();
+	}
+
+	void JsonDomHandler::SetArena(std::pmr::memory_resource* arena)
+	{
+		this->arena = arena;
+	}
+
+	void JsonDomHandler::SetKeyTable(JsonKeyTable* keyTable)
+	{
+		this->keyTable = keyTable;
+	}
+
+	JsonObject& JsonDomHandler::NextValue()
+	{
+		if (stack.empty())
+			return *root;
+
+		Frame& frame = stack.back();
+		if (frame.container->IsObject())
+			return *memberValue;
+
+		// Elements are stable until this array ends, nested containers are finished first.
+		JsonObject::ElementArray& elements = frame.container->_value.Array;
+		if (frame.index == elements.size())
+			elements.emplace_back();
+		return elements[frame.index++];
+	}
+
+	void JsonDomHandler::MarkVisited(JsonObject& value)
+	{
+		if (!stack.empty() && stack.back().container->IsObject())
+			value.flags |= JsonObject::visitedFlag;
+	}
+
+	JsonString JsonDomHandler::MakeName(string_view key)
+	{
+		if (keyTable != nullptr)
+		{
+			string_view name = keyTable->Intern(key);
+			return JsonString::Borrow(name.data(), name.length());
+		}
+		if (borrowStrings)
+			return JsonString::Borrow(key.data(), key.length());
+		if (arena != nullptr)
+			return JsonString::Borrow(CopyToArena(key), key.length());
+		return JsonString(key.data(), key.length());
+	}
+
+	const char* JsonDomHandler::CopyToArena(string_view value)
+	{
+		char* copy = static_cast<char*>(arena->allocate(value.length() + 1, 1));
+		memcpy(copy, value.data(), value.length());
+		copy[value.length()] = '\0';
+		return copy;
+	}
+}
@@ -0,0 +1,33 @@
+#include "JsonKeyTable.h"
+
+namespace Json
+{
+	JsonKeyTable::JsonKeyTable(size_t chunkSize)
+		: storage(chunkSize)
+	{
+	}
+
+	string_view JsonKeyTable::Intern(string_view name)
+	{
+		auto it = names.find(name);
+		if (it != names.end())
+			return *it;
+
+		char* copy = static_cast<char*>(storage.allocate(name.length() + 1, 1));
+		name.copy(copy, name.length());
+		copy[name.length()] = '\0';
+		return *names.insert(string_view(copy, name.length())).first;
+	}
+
+	string_view JsonKeyTable::Find(string_view name) const
+	{
+		auto it = names.find(name);
+		return it != names.end() ? *it : string_view();
+	}
+
+	void JsonKeyTable::Clear()
+	{
+		names.clear();
+		storage.Release();
+	}
+}
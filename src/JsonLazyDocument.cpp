@@ -0,0 +1,341 @@
+#include "JsonLazyDocument.h"
+#include "JsonReader.h"
+#include "JsonNumberParser.h"
+#include "JsonStringDecoder.h"
+#include <cstring>
+
+namespace Json
+{
+	namespace
+	{
+		inline const char* SkipSpaces(const char* current, const char* end)
+		{
+			while (current != end && (*current == ' ' || *current == '\n' || *current == '\t' || *current == '\r'))
+				++current;
+			return current;
+		}
+
+		/** 'current' points to opening quote. Returns position after closing quote, or nullptr. */
+		const char* SkipString(const char* current, const char* end)
+		{
+			const char* bodyBegin = current + 1;
+			current = bodyBegin;
+			while (current != end)
+			{
+				const char* quote = static_cast<const char*>(memchr(current, '"', end - current));
+				if (quote == nullptr)
+					return nullptr;
+
+				// Quote is escaped if preceded by odd number of backslashes.
+				const char* backslash = quote;
+				while (backslash != bodyBegin && *(backslash - 1) == '\\')
+					--backslash;
+				if (((quote - backslash) & 1) == 0)
+					return quote + 1;
+				current = quote + 1;
+			}
+			return nullptr;
+		}
+
+		/** Returns position after the value starting at 'current', or nullptr if it is malformed.
+		* Containers are passed over by matching brackets, their contents are not validated. */
+		const char* SkipValue(const char* current, const char* end)
+		{
+			if (current == end)
+				return nullptr;
+
+			char c = *current;
+			if (c == '"')
+				return SkipString(current, end);
+			if (c == '{' || c == '[')
+			{
+				size_t depth = 0;
+				while (current != end)
+				{
+					switch (*current)
+					{
+					case '"':
+						current = SkipString(current, end);
+						if (current == nullptr)
+							return nullptr;
+						continue;
+					case '{':
+					case '[':
+						++depth;
+						break;
+					case '}':
+					case ']':
+						if (--depth == 0)
+							return current + 1;
+						break;
+					default:
+						break;
+					}
+					++current;
+				}
+				return nullptr;
+			}
+			if (c == '}' || c == ']' || c == ',' || c == ':')
+				return nullptr;
+
+			// Number or literal.
+			while (current != end)
+			{
+				c = *current;
+				if (c == ',' || c == '}' || c == ']' || c == ':' || c == '"' || c == '[' || c == '{' ||
+					c == ' ' || c == '\n' || c == '\t' || c == '\r')
+					break;
+				++current;
+			}
+			return current;
+		}
+	}
+
+	JsonLazyValue JsonLazyValue::operator[](const char* key) const
+	{
+		return FindMember(key, strlen(key));
+	}
+
+	JsonLazyValue JsonLazyValue::operator[](const string& key) const
+	{
+		return FindMember(key.c_str(), key.length());
+	}
+
+	JsonLazyValue JsonLazyValue::operator[](int index) const
+	{
+		if (!IsArray() || index < 0)
+			return JsonLazyValue();
+
+		const char* current = SkipSpaces(start + 1, end);
+		if (current != end && *current == ']')
+			return JsonLazyValue();
+		for (int i = 0; current != end; ++i)
+		{
+			if (i == index)
+				return JsonLazyValue(current, end);
+
+			current = SkipValue(current, end);
+			if (current == nullptr)
+				break;
+			current = SkipSpaces(current, end);
+			if (current == end || *current != ',')
+				break;
+			current = SkipSpaces(current + 1, end);
+		}
+		return JsonLazyValue();
+	}
+
+	bool JsonLazyValue::IsMember(const char* key) const
+	{
+		return FindMember(key, strlen(key)).IsValid();
+	}
+
+	bool JsonLazyValue::IsMember(const string& key) const
+	{
+		return FindMember(key.c_str(), key.length()).IsValid();
+	}
+
+	int JsonLazyValue::Size() const
+	{
+		if (!IsObject() && !IsArray())
+			return 0;
+
+		char close = *start == '{' ? '}' : ']';
+		const char* current = SkipSpaces(start + 1, end);
+		if (current != end && *current == close)
+			return 0;
+
+		int size = 0;
+		while (current != end)
+		{
+			// Member name is skipped as a value, then value after ':'.
+			current = SkipValue(current, end);
+			if (current == nullptr)
+				break;
+			current = SkipSpaces(current, end);
+			if (close == '}')
+			{
+				if (current == end || *current != ':')
+					break;
+				current = SkipValue(SkipSpaces(current + 1, end), end);
+				if (current == nullptr)
+					break;
+				current = SkipSpaces(current, end);
+			}
+			++size;
+			if (current == end || *current != ',')
+				break;
+			current = SkipSpaces(current + 1, end);
+		}
+		return size;
+	}
+
+	ValueType JsonLazyValue::GetType() const
+	{
+		if (start == nullptr)
+			return ValueType::Null;
+
+		switch (*start)
+		{
+		case '{':
+			return ValueType::Object;
+		case '[':
+			return ValueType::Array;
+		case '"':
+			return ValueType::String;
+		case 't':
+		case 'f':
+			return ValueType::Bool;
+		case 'n':
+			return ValueType::Null;
+		default:
+		{
+			JsonNumberParser::Number number;
+			const char* numberEnd = SkipValue(start, end);
+			if (numberEnd == nullptr || !JsonNumberParser::Parse(start, numberEnd, number))
+				return ValueType::Null;
+			return number.type;
+		}
+		}
+	}
+
+	bool JsonLazyValue::IsNumeric() const
+	{
+		return start != nullptr && (*start == '-' || (*start >= '0' && *start <= '9')) && GetType() != ValueType::Null;
+	}
+
+	string JsonLazyValue::AsString() const { return ToScalar().AsString(); }
+	bool JsonLazyValue::AsBool() const { return ToScalar().AsBool(); }
+	int JsonLazyValue::AsInt() const { return ToScalar().AsInt(); }
+	unsigned int JsonLazyValue::AsUInt() const { return ToScalar().AsUInt(); }
+	float JsonLazyValue::AsFloat() const { return ToScalar().AsFloat(); }
+	int64_t JsonLazyValue::AsInt64() const { return ToScalar().AsInt64(); }
+	uint64_t JsonLazyValue::AsUInt64() const { return ToScalar().AsUInt64(); }
+	double JsonLazyValue::AsDouble() const { return ToScalar().AsDouble(); }
+
+	bool JsonLazyValue::AsString(string& value) const { return ToScalar().AsString(value); }
+	bool JsonLazyValue::AsBool(bool& value) const { return ToScalar().AsBool(value); }
+	bool JsonLazyValue::AsInt(int& value) const { return ToScalar().AsInt(value); }
+	bool JsonLazyValue::AsUInt(unsigned int& value) const { return ToScalar().AsUInt(value); }
+	bool JsonLazyValue::AsFloat(float& value) const { return ToScalar().AsFloat(value); }
+	bool JsonLazyValue::AsInt64(int64_t& value) const { return ToScalar().AsInt64(value); }
+	bool JsonLazyValue::AsUInt64(uint64_t& value) const { return ToScalar().AsUInt64(value); }
+	bool JsonLazyValue::AsDouble(double& value) const { return ToScalar().AsDouble(value); }
+
+	bool JsonLazyValue::ToObject(JsonObject& object) const
+	{
+		if (!IsObject() && !IsArray())
+			return ParseScalar(object);
+
+		const char* valueEnd = SkipValue(start, end);
+		if (valueEnd == nullptr)
+			return false;
+		JsonReader reader;
+		return reader.Parse(start, valueEnd, object);
+	}
+
+	JsonLazyValue JsonLazyValue::FindMember(const char* key, size_t keyLength) const
+	{
+		if (!IsObject())
+			return JsonLazyValue();
+
+		string decodedName;
+		const char* current = SkipSpaces(start + 1, end);
+		while (current != end && *current == '"')
+		{
+			const char* nameEnd = SkipString(current, end);
+			if (nameEnd == nullptr)
+				break;
+
+			// Names are compared raw, unless they contain escapes.
+			const char* nameBegin = current + 1;
+			size_t nameLength = nameEnd - 1 - nameBegin;
+			bool matches;
+			if (memchr(nameBegin, '\\', nameLength) == nullptr)
+				matches = nameLength == keyLength && memcmp(nameBegin, key, keyLength) == 0;
+			else
+			{
+				decodedName.clear();
+				matches = JsonStringDecoder::Decode(nameBegin, nameEnd - 1, decodedName) &&
+					decodedName.length() == keyLength && memcmp(decodedName.data(), key, keyLength) == 0;
+			}
+
+			current = SkipSpaces(nameEnd, end);
+			if (current == end || *current != ':')
+				break;
+			current = SkipSpaces(current + 1, end);
+			if (matches)
+				return JsonLazyValue(current, end);
+
+			current = SkipValue(current, end);
+			if (current == nullptr)
+				break;
+			current = SkipSpaces(current, end);
+			if (current == end || *current != ',')
+				break;
+			current = SkipSpaces(current + 1, end);
+		}
+		return JsonLazyValue();
+	}
+
+	bool JsonLazyValue::ParseScalar(JsonObject& object) const
+	{
+		const char* valueEnd = start != nullptr ? SkipValue(start, end) : nullptr;
+		if (valueEnd == nullptr)
+			return false;
+
+		size_t length = valueEnd - start;
+		switch (*start)
+		{
+		case '"':
+		{
+			string decoded;
+			if (!JsonStringDecoder::Decode(start + 1, valueEnd - 1, decoded))
+				return false;
+			object = JsonObject(decoded);
+			return true;
+		}
+		case 't':
+			object = JsonObject(true);
+			return length == 4 && memcmp(start, "true", 4) == 0;
+		case 'f':
+			object = JsonObject(false);
+			return length == 5 && memcmp(start, "false", 5) == 0;
+		case 'n':
+			object = JsonObject();
+			return length == 4 && memcmp(start, "null", 4) == 0;
+		case '{':
+		case '[':
+			return false;
+		default:
+			return JsonNumberParser::Parse(start, valueEnd, object);
+		}
+	}
+
+	JsonObject JsonLazyValue::ToScalar() const
+	{
+		JsonObject object;
+		if (!ParseScalar(object))
+			return JsonObject();
+		return object;
+	}
+
+	bool JsonLazyDocument::Load(const char* beginText, const char* endText)
+	{
+		errorMessage.clear();
+		const char* current = SkipSpaces(beginText, endText);
+		if (current == endText || (*current != '{' && *current != '['))
+		{
+			root = JsonLazyValue();
+			errorMessage = "A valid JSON document must be either an array or an object value.";
+			return false;
+		}
+		root = JsonLazyValue(current, endText);
+		return true;
+	}
+
+	bool JsonLazyDocument::Load(const string& json)
+	{
+		return Load(json.c_str(), json.c_str() + json.length());
+	}
+}
@@ -0,0 +1,179 @@
+#include "JsonLinesReader.h"
+#include "JsonMappedFile.h"
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+namespace Json
+{
+	namespace
+	{
+		// Parsed record waiting for delivery.
+		struct Slot
+		{
+			JsonObject record;
+			size_t line = 0;
+			bool ready = false;
+			bool succeed = false;
+			string errorMessage;
+		};
+
+		// State shared by the delivering thread and workers, guarded by 'mutex'.
+		struct SharedState
+		{
+			std::mutex mutex;
+			// Signaled when a slot is freed or reading stops.
+			std::condition_variable slotFreed;
+			// Signaled when a record is parsed or input is exhausted.
+			std::condition_variable recordReady;
+
+			const char* current;
+			const char* end;
+			size_t line = 0;
+			// Sequence number of the next record to claim.
+			size_t claimed = 0;
+			size_t delivered = 0;
+			bool exhausted = false;
+			bool stop = false;
+		};
+
+		inline bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+		}
+
+		/** Find next non-blank line, advancing 'state.current' past it. */
+		bool NextRecord(SharedState& state, const char*& recordBegin, const char*& recordEnd)
+		{
+			while (state.current != state.end)
+			{
+				// memchr is vectorized by the C library.
+				const char* lineEnd = static_cast<const char*>(memchr(state.current, '\n', state.end - state.current));
+				if (lineEnd == nullptr)
+					lineEnd = state.end;
+
+				recordBegin = state.current;
+				recordEnd = lineEnd;
+				state.current = lineEnd != state.end ? lineEnd + 1 : lineEnd;
+				state.line++;
+
+				while (recordBegin != recordEnd && IsSpace(*recordBegin))
+					++recordBegin;
+				if (recordBegin != recordEnd)
+					return true;
+			}
+			return false;
+		}
+
+		void ParseRecords(SharedState& state, vector<Slot>& slots, ReaderMode mode)
+		{
+			JsonReader reader;
+			reader.SetMode(mode);
+			std::unique_lock<std::mutex> lock(state.mutex);
+			while (true)
+			{
+				state.slotFreed.wait(lock, [&] { return state.stop || state.claimed < state.delivered + slots.size(); });
+				if (state.stop || state.exhausted)
+					return;
+
+				const char* recordBegin;
+				const char* recordEnd;
+				if (!NextRecord(state, recordBegin, recordEnd))
+				{
+					state.exhausted = true;
+					state.recordReady.notify_all();
+					return;
+				}
+				// Slot is free, its previous record was delivered.
+				Slot& slot = slots[state.claimed++ % slots.size()];
+				slot.line = state.line;
+				lock.unlock();
+
+				slot.succeed = reader.Parse(recordBegin, recordEnd, slot.record);
+				if (!slot.succeed)
+					slot.errorMessage = reader.GetErrorMessage();
+
+				lock.lock();
+				slot.ready = true;
+				state.recordReady.notify_all();
+			}
+		}
+	}
+
+	JsonLinesReader::JsonLinesReader(unsigned int threadCount)
+		: threadCount(threadCount != 0 ? threadCount : std::thread::hardware_concurrency())
+	{
+		if (this->threadCount == 0)
+			this->threadCount = 1;
+	}
+
+	bool JsonLinesReader::Parse(const char* beginText, const char* endText, const RecordCallback& callback)
+	{
+		errorMessage.clear();
+
+		SharedState state;
+		state.current = beginText;
+		state.end = endText;
+		vector<Slot> slots(maxInFlight);
+
+		vector<std::thread> workers;
+		workers.reserve(threadCount);
+		for (unsigned int i = 0; i < threadCount; ++i)
+			workers.emplace_back(ParseRecords, std::ref(state), std::ref(slots), mode);
+
+		bool succeed = true;
+		for (size_t sequence = 0; ; ++sequence)
+		{
+			Slot& slot = slots[sequence % slots.size()];
+			{
+				std::unique_lock<std::mutex> lock(state.mutex);
+				state.recordReady.wait(lock, [&] { return slot.ready || (state.exhausted && sequence == state.claimed); });
+				if (!slot.ready)
+					break; // All records delivered.
+			}
+
+			if (!slot.succeed)
+			{
+				errorMessage = "Record at line " + std::to_string(slot.line) + ": " + slot.errorMessage;
+				succeed = false;
+				break;
+			}
+			if (!callback(slot.line, slot.record))
+			{
+				errorMessage = "Reading stopped by callback.";
+				succeed = false;
+				break;
+			}
+
+			// Record is kept, the next line parsed into this slot reuses its memory.
+			std::lock_guard<std::mutex> lock(state.mutex);
+			slot.ready = false;
+			state.delivered++;
+			state.slotFreed.notify_all();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(state.mutex);
+			state.stop = true;
+			state.slotFreed.notify_all();
+		}
+		for (std::thread& worker : workers)
+			worker.join();
+		return succeed;
+	}
+
+	bool JsonLinesReader::ParseFile(const string& path, const RecordCallback& callback)
+	{
+		JsonMappedFile file;
+		if (!file.Open(path.c_str()))
+		{
+			errorMessage = file.GetErrorMessage();
+			return false;
+		}
+		return Parse(file.Begin(), file.End(), callback);
+	}
+}
@@ -0,0 +1,127 @@
+#include "JsonMappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Json
+{
+	JsonMappedFile::~JsonMappedFile()
+	{
+		Close();
+	}
+
+#ifdef _WIN32
+	bool JsonMappedFile::Open(const char* path)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return SetError("Failed to open file: ", path);
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize))
+		{
+			CloseHandle(file);
+			return SetError("Failed to get size of file: ", path);
+		}
+
+		size = static_cast<size_t>(fileSize.QuadPart);
+		if (size == 0)
+		{
+			CloseHandle(file);
+			data = "";
+			return true;
+		}
+
+		mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		// Mapping keeps the file open.
+		CloseHandle(file);
+		if (mappingHandle == nullptr)
+			return SetError("Failed to map file: ", path);
+
+		data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		if (data == nullptr)
+			return SetError("Failed to map file: ", path);
+
+		isMapped = true;
+		return true;
+	}
+
+	void JsonMappedFile::Close()
+	{
+		if (isMapped)
+			UnmapViewOfFile(data);
+		if (mappingHandle != nullptr)
+			CloseHandle(mappingHandle);
+
+		mappingHandle = nullptr;
+		data = nullptr;
+		size = 0;
+		isMapped = false;
+	}
+#else
+	bool JsonMappedFile::Open(const char* path)
+	{
+		Close();
+
+		int file = open(path, O_RDONLY);
+		if (file == -1)
+			return SetError("Failed to open file: ", path);
+
+		struct stat status;
+		if (fstat(file, &status) == -1)
+		{
+			close(file);
+			return SetError("Failed to get size of file: ", path);
+		}
+
+		size = static_cast<size_t>(status.st_size);
+		if (size == 0) // mmap fails on zero length.
+		{
+			close(file);
+			data = "";
+			return true;
+		}
+
+		void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+		// Mapping keeps the file open.
+		close(file);
+		if (mapping == MAP_FAILED)
+			return SetError("Failed to map file: ", path);
+
+		// Read-ahead aggressively, pages behind are dropped first.
+		madvise(mapping, size, MADV_SEQUENTIAL);
+
+		data = static_cast<const char*>(mapping);
+		isMapped = true;
+		return true;
+	}
+
+	void JsonMappedFile::Close()
+	{
+		if (isMapped)
+			munmap(const_cast<char*>(data), size);
+
+		data = nullptr;
+		size = 0;
+		isMapped = false;
+	}
+#endif
+
+	bool JsonMappedFile::SetError(const char* message, const char* path)
+	{
+		Close();
+		errorMessage = message;
+		errorMessage += path;
+		return false;
+	}
+}
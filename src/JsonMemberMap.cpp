@@ -0,0 +1,42 @@
+#include "JsonMemberMap.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace Json
+{
+	size_t JsonMemberMapBase::FindTag(const uint32_t* tags, size_t count, size_t start, uint32_t tag)
+	{
+		size_t i = start;
+#ifdef JSON_SSE2
+		// Compare 4 tags at once.
+		const __m128i needle = _mm_set1_epi32(static_cast<int>(tag));
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+			unsigned int mask = static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, needle))));
+			if (mask != 0)
+			{
+#ifdef _MSC_VER
+				unsigned long index;
+				_BitScanForward(&index, mask);
+				return i + index;
+#else
+				return i + __builtin_ctz(mask);
+#endif
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			if (tags[i] == tag)
+				return i;
+		}
+		return count;
+	}
+}
@@ -1,23 +1,97 @@
 #include "JsonObject.h"
 #include "Assertions.h"
+#include "JsonNumberParser.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <mutex>
 #include <limits.h>
 #include <float.h>
 
 namespace Json
 {
+	namespace
+	{
+		/** Returns integer in the smallest type fitting it, as 'JsonNumberParser' gives parsed ones. */
+		JsonObject IntegerAsParsed(int64_t value)
+		{
+			if (value >= 0)
+				return value <= UINT_MAX ? JsonObject(static_cast<unsigned int>(value)) : JsonObject(static_cast<uint64_t>(value));
+			return value >= INT_MIN ? JsonObject(static_cast<int>(value)) : JsonObject(value);
+		}
+
+		/** Final mix of 64-bit hash, so every input bit affects every output bit. */
+		inline uint64_t MixHash(uint64_t hash)
+		{
+			hash ^= hash >> 33;
+			hash *= 0xFF51AFD7ED558CCDull;
+			hash ^= hash >> 33;
+			hash *= 0xC4CEB9FE1A85EC53ull;
+			hash ^= hash >> 33;
+			return hash;
+		}
+
+		inline uint64_t HashReal(uint64_t seed, double value)
+		{
+			// Zeros of both signs are equal.
+			if (value == 0)
+				value = 0;
+			uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return MixHash(seed ^ bits);
+		}
+
+		// Cached hashes are valid in the generation they were computed in, see 'JsonObject::Modified'.
+		// Bit 0 is set once a hash is cached in the current generation, the others count generations.
+		std::atomic<uint64_t> hashGeneration{ 2 };
+
+		inline uint64_t CurrentGeneration()
+		{
+			return hashGeneration.load(std::memory_order_acquire) >> 1;
+		}
+
+		/** Note a hash was cached in the current generation, so modifying any value starts the next one. */
+		inline void HashCached()
+		{
+			if ((hashGeneration.load(std::memory_order_relaxed) & 1) == 0)
+				hashGeneration.fetch_or(1, std::memory_order_acq_rel);
+		}
+
+		// Characters of number tokens by their 4-bit codes in packed tokens.
+		constexpr char rawCharacters[] = "0123456789.eE+-";
+
+		/** Returns code of number token character 'c', see 'rawCharacters'. */
+		inline uint64_t RawCode(char c)
+		{
+			if (c >= '0' && c <= '9')
+				return static_cast<uint64_t>(c - '0');
+			switch (c)
+			{
+			case '.': return 10;
+			case 'e': return 11;
+			case 'E': return 12;
+			case '+': return 13;
+			default: return 14; // '-', tokens hold no other characters.
+			}
+		}
+	}
+
 	const JsonObject& JsonObject::NullSingleton()
 	{
 		static const JsonObject nullStatic;
 		return nullStatic;
 	}
 
-	constexpr JsonObject::JsonObject(ValueType type)
+	JsonObject::JsonObject(ValueType type)
 		: type(type)
 	{
 		switch (type)
 		{
 		case Json::ValueType::Null:
-			_value.Map = nullptr;
+			_value.String = nullptr;
 			break;
 		case Json::ValueType::String:
 			_value.String = nullptr;
@@ -34,14 +108,23 @@ namespace Json
 		case Json::ValueType::Float:
 			_value.Float = 0.0f;
 			break;
+		case Json::ValueType::Int64:
+			_value.Int64 = 0;
+			break;
+		case Json::ValueType::UInt64:
+			_value.UInt64 = 0u;
+			break;
+		case Json::ValueType::Double:
+			_value.Double = 0.0;
+			break;
 		case Json::ValueType::Object:
-			_value.Map = new unordered_map<string, JsonObject>;
+			_value.Map = MemberMap();
 			break;
 		case Json::ValueType::Array:
-			_value.Array = new vector<JsonObject>;
+			_value.Array = ElementArray();
 			break;
 		default:
-			_value.Map = nullptr;
+			_value.String = nullptr;
 			break;
 		}
 	}
@@ -49,34 +132,61 @@ namespace Json
 	JsonObject::JsonObject(const char* value)
 	{
 		type = ValueType::String;
-		_value.String = DublicateStringValue(value, strlen(value));
+		InitString(value, static_cast<uint32_t>(strlen(value)));
 	}
 
 	JsonObject::JsonObject(const string& value)
 	{
 		type = ValueType::String;
-		_value.String = DublicateStringValue(value.data(), value.length());
+		InitString(value.data(), static_cast<uint32_t>(value.length()));
+	}
+
+	JsonObject::JsonObject(string_view value)
+	{
+		type = ValueType::String;
+		InitString(value.data(), static_cast<uint32_t>(value.length()));
 	}
 
 	JsonObject::JsonObject(const JsonObject& other)
 	{
 		type = other.type;
+		length = other.length;
 		// If type is object/array do deep copy.
 		if (type == ValueType::Object)
-			_value.Map = new unordered_map<string, JsonObject>(*other._value.Map);
+			_value.Map = other._value.Map.Clone();
+		else if ((other.flags & packedIntFlag) != 0)
+		{
+			flags = packedIntFlag;
+			_value.Int64s = other._value.Int64s.Clone();
+		}
+		else if ((other.flags & packedDoubleFlag) != 0)
+		{
+			flags = packedDoubleFlag;
+			_value.Doubles = other._value.Doubles.Clone();
+		}
 		else if (type == ValueType::Array)
-			_value.Array = new vector<JsonObject>(*other._value.Array);
-		else if (type == ValueType::String)
-			_value.String = DublicateStringValue(other._value.String, strlen(other._value.String));
+			_value.Array = other._value.Array.Clone();
+		else if (other.IsRawNumber())
+		{
+			char buffer[rawInlineCapacity];
+			InitRawNumber(other.RawToken(buffer), false);
+		}
+		else if (type == ValueType::String) // Copy owns its characters, even if 'other' borrows them.
+		{
+			if (length == 0)
+				_value.String = nullptr;
+			else
+				InitString(other.StringData(), length);
+		}
 		else
 			_value = other._value;
 	}
 
-	constexpr JsonObject::JsonObject(JsonObject&& other) noexcept
-		: type(other.type), _value(std::move(other._value))
+	JsonObject::JsonObject(JsonObject&& other) noexcept
+		: type(other.type), flags(other.flags), capacity(other.capacity), length(other.length), _value(std::move(other._value))
 	{
 		// Reset.
-		other._value.Map = nullptr;
+		other._value.String = nullptr;
 	}
 
 	JsonObject::~JsonObject()
@@ -85,15 +195,29 @@ namespace Json
 		CleanUp();
 	}
 
+	JsonObject JsonObject::BorrowString(const char* value, unsigned int length)
+	{
+		JsonObject object(ValueType::String);
+		object.flags |= borrowedFlag;
+		object.length = length;
+		// Cast is safe, borrowed characters are never written or released.
+		object._value.String = const_cast<char*>(value);
+		return object;
+	}
+
 	JsonObject& JsonObject::operator=(JsonObject&& other) noexcept
 	{
+		Modified();
 		// Cleanup.
 		CleanUp();
 		// Member-wise move.
 		type = other.type;
+		flags = other.flags;
+		capacity = other.capacity;
+		length = other.length;
 		_value = std::move(other._value);
 		// Reset.
-		other._value.Map = nullptr;
+		other._value.String = nullptr;
 
 		return *this;
 	}
@@ -104,20 +228,14 @@ namespace Json
 		if (GetType() != other.GetType())
 			return false;
 
+		uint64_t hash, otherHash, generation = CurrentGeneration();
+
 		switch (GetType())
 		{
 		case Json::ValueType::Null:
 			return true;
 		case Json::ValueType::String:
-		{
-			unsigned int length = strlen(_value.String);
-			unsigned int otherLength = strlen(other._value.String);
-			if (length != otherLength)
-				return false;
-
-			int cmp = strcmp(_value.String, other._value.String);
-			return cmp == 0;
-		}
+			return AsStringView() == other.AsStringView();
 		case Json::ValueType::Bool:
 			return _value.Bool == other._value.Bool;
 		case Json::ValueType::Int:
@@ -127,16 +245,46 @@ namespace Json
 			return _value.UInt == other._value.UInt;
 		case Json::ValueType::Float:
 			return _value.Float == other._value.Float;
+		case Json::ValueType::Int64:
+			return _value.Int64 == other._value.Int64;
+		case Json::ValueType::UInt64:
+			return _value.UInt64 == other._value.UInt64;
+		case Json::ValueType::Double:
+			if (IsRawNumber() || other.IsRawNumber())
+				return AsDouble() == other.AsDouble();
+			return _value.Double == other._value.Double;
 		case Json::ValueType::Object:
-			if (_value.Map->size() != other._value.Map->size())
+			// Sizes and cached hashes are compared without reading the containers.
+			if (length != other.length)
+				return false;
+			if (CachedHash(hash, generation) && other.CachedHash(otherHash, generation) && hash != otherHash)
 				return false;
 
-			return (*_value.Map) == (*other._value.Map);
+			return _value.Map == other._value.Map;
 		case Json::ValueType::Array:
-			if (_value.Array->size() != other._value.Array->size())
+			if (length != other.length)
+				return false;
+			if (CachedHash(hash, generation) && other.CachedHash(otherHash, generation) && hash != otherHash)
 				return false;
 
-			return (*_value.Array) == (*other._value.Array);
+			if ((flags & other.flags & packedIntFlag) != 0)
+				return std::equal(_value.Int64s.begin(), _value.Int64s.end(), other._value.Int64s.begin());
+			if ((flags & other.flags & packedDoubleFlag) != 0)
+				return std::equal(_value.Doubles.begin(), _value.Doubles.end(), other._value.Doubles.begin());
+			if (IsPackedArray() || other.IsPackedArray())
+			{
+				// Packed elements are compared as values they stand for, without unpacking.
+				for (size_t i = 0; i < length; ++i)
+				{
+					bool equal = IsPackedArray() ?
+						(other.IsPackedArray() ? PackedElement(i) == other.PackedElement(i) : PackedElement(i) == other._value.Array[i]) :
+						_value.Array[i] == other.PackedElement(i);
+					if (!equal)
+						return false;
+				}
+				return true;
+			}
+			return _value.Array == other._value.Array;
 		default:
 			return false; // unreachable.
 		}
@@ -147,31 +295,125 @@ namespace Json
 		return !(*this == other);
 	}
 
+	uint64_t JsonObject::Hash() const
+	{
+		// Values of different types are never equal, so the type seeds the hash.
+		constexpr uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+		uint64_t seed = (static_cast<uint64_t>(type) + 1) * multiplier;
+		switch (type)
+		{
+		case ValueType::Null:
+			return MixHash(seed);
+		case ValueType::String:
+			return MixHash(seed ^ JsonKey::HashName(AsStringView()));
+		case ValueType::Bool:
+			return MixHash(seed ^ static_cast<uint64_t>(_value.Bool));
+		case ValueType::Int:
+			return MixHash(seed ^ static_cast<uint64_t>(static_cast<int64_t>(_value.Int)));
+		case ValueType::UInt:
+			return MixHash(seed ^ _value.UInt);
+		case ValueType::Float:
+			return HashReal(seed, _value.Float);
+		case ValueType::Int64:
+			return MixHash(seed ^ static_cast<uint64_t>(_value.Int64));
+		case ValueType::UInt64:
+			return MixHash(seed ^ _value.UInt64);
+		case ValueType::Double:
+			return HashReal(seed, IsRawNumber() ? RawNumberValue() : _value.Double);
+		case ValueType::Object:
+		case ValueType::Array:
+			break;
+		default:
+			return 0; // unreachable.
+		}
+
+		uint64_t hash, generation = CurrentGeneration();
+		if (CachedHash(hash, generation))
+			return hash;
+
+		hash = seed ^ (length * multiplier);
+		if (type == ValueType::Object)
+		{
+			// Sum of member hashes does not depend on their order.
+			uint64_t memberSum = 0;
+			for (const auto& member : _value.Map)
+				memberSum += MixHash(JsonKey::HashName(member.first.View()) ^ (member.second.Hash() * multiplier));
+			hash = MixHash(hash + memberSum);
+			_value.Map.cache_hash(hash, generation);
+		}
+		else if (IsPackedArray())
+		{
+			// Packed elements are hashed as values they stand for, as they compare.
+			for (size_t i = 0; i < length; ++i)
+				hash = (hash ^ PackedElement(i).Hash()) * multiplier;
+			hash = MixHash(hash);
+			if ((flags & packedIntFlag) != 0)
+				_value.Int64s.cache_hash(hash, generation);
+			else
+				_value.Doubles.cache_hash(hash, generation);
+		}
+		else
+		{
+			for (const JsonObject& element : _value.Array)
+				hash = (hash ^ element.Hash()) * multiplier;
+			hash = MixHash(hash);
+			_value.Array.cache_hash(hash, generation);
+		}
+		HashCached();
+		return hash;
+	}
+
 	const JsonObject& JsonObject::operator[](const char* key) const
 	{
-		string sKey = key;
-		return (*this)[sKey];
+		return (*this)[string_view(key)];
 	}
 
 	const JsonObject& JsonObject::operator[](const string& key) const
+	{
+		return (*this)[string_view(key)];
+	}
+
+	const JsonObject& JsonObject::operator[](string_view key) const
+	{
+		ASSERT_TRUE((GetType() == ValueType::Object || GetType() == ValueType::Null),
+			"in JsonObject::operator[] requires ObjectValue!");
+
+		if (GetType() == ValueType::Null)
+			return NullSingleton();
+
+		auto itr = _value.Map.find(key);
+		if (itr == _value.Map.end())
+			return NullSingleton();
+		return itr->second;
+	}
+
+	const JsonObject& JsonObject::operator[](const JsonKey& key) const
 	{
 		ASSERT_TRUE((GetType() == ValueType::Object || GetType() == ValueType::Null),
 			"in JsonObject::operator[] requires ObjectValue!");
 
-		auto itr = _value.Map->find(key);
-		if (itr == _value.Map->end())
+		if (GetType() == ValueType::Null)
+			return NullSingleton();
+
+		auto itr = _value.Map.find(key);
+		if (itr == _value.Map.end())
 			return NullSingleton();
 		return itr->second;
 	}
 
 	JsonObject& JsonObject::operator[](const char* key)
 	{
-		string sKey = key;
-		return (*this)[sKey];
+		return (*this)[string_view(key)];
 	}
 
 	JsonObject& JsonObject::operator[](const string& key)
 	{
+		return (*this)[string_view(key)];
+	}
+
+	JsonObject& JsonObject::operator[](string_view key)
+	{
+		Modified();
 		ASSERT_TRUE((GetType() == ValueType::Object || GetType() == ValueType::Null),
 			"in JsonObject::operator[] requires ObjectValue or NullValue!");
 
@@ -179,12 +421,53 @@ namespace Json
 		if (GetType() == ValueType::Null)
 			(*this) = JsonObject(ValueType::Object);
 
-		auto itr = _value.Map->find(key);
-		if (itr != _value.Map->end()) // If exists.
+		auto itr = _value.Map.find(key);
+		if (itr != _value.Map.end()) // If exists.
+			return itr->second;
+
+		JsonObject& value = _value.Map.emplace(JsonString(key.data(), key.length()), JsonObject()).first->second;
+		UpdateSize();
+		return value;
+	}
+
+	JsonObject& JsonObject::operator[](const JsonKey& key)
+	{
+		Modified();
+		ASSERT_TRUE((GetType() == ValueType::Object || GetType() == ValueType::Null),
+			"in JsonObject::operator[] requires ObjectValue or NullValue!");
+
+		// If NullValue, then make ObjectValue.
+		if (GetType() == ValueType::Null)
+			(*this) = JsonObject(ValueType::Object);
+
+		auto itr = _value.Map.find(key);
+		if (itr != _value.Map.end()) // If exists.
+			return itr->second;
+
+		JsonObject& value = _value.Map.emplace(JsonString(key.View().data(), key.View().length()), JsonObject()).first->second;
+		UpdateSize();
+		return value;
+	}
+
+	JsonObject& JsonObject::SetMember(JsonString&& key, JsonObject&& value)
+	{
+		Modified();
+		ASSERT_TRUE((GetType() == ValueType::Object || GetType() == ValueType::Null),
+			"in JsonObject::SetMember requires ObjectValue or NullValue!");
+
+		// If NullValue, then make ObjectValue.
+		if (GetType() == ValueType::Null)
+			(*this) = JsonObject(ValueType::Object);
+
+		auto itr = _value.Map.find(key.View());
+		if (itr != _value.Map.end()) // If exists, replace value.
+		{
+			itr->second = std::move(value);
 			return itr->second;
+		}
 
-		std::pair<string, JsonObject> defaultValue(key, JsonObject());
-		itr = _value.Map->insert(itr, std::move(defaultValue));
+		itr = _value.Map.emplace(std::move(key), std::move(value)).first;
+		UpdateSize();
 		return itr->second;
 	}
 
@@ -195,73 +478,92 @@ namespace Json
 		ASSERT_TRUE((GetType() == ValueType::Array),
 			"in JsonObject::operator[](int index): requires ArrayValue!");
 
-		return _value.Array->at(index);
+		if (IsPackedArray())
+			return index >= 0 && index < Size() ? PackedElements()[index] : NullSingleton();
+		return _value.Array.at(index);
 	}
 
 	JsonObject& JsonObject::operator[](int index)
 	{
+		Modified();
 		ASSERT_TRUE((index >= 0 && index < Size()),
 			"in JsonObject::operator[](int index): index out of range.");
 		ASSERT_TRUE((GetType() == ValueType::Array),
 			"in JsonObject::operator[](int index): requires ArrayValue!");
 
-		return _value.Array->at(index);
+		Unpack();
+		return _value.Array.at(index);
+	}
+
+	JsonObject JsonObject::GetElement(int index) const
+	{
+		if (GetType() != ValueType::Array || index < 0 || index >= Size())
+			return JsonObject();
+		if (IsPackedArray())
+			return PackedElement(index);
+		return JsonObject(_value.Array[index]);
 	}
 
 	JsonObject::ObjectIterator JsonObject::ObjectBegin()
 	{
+		Modified();
 		if (GetType() != ValueType::Object)
 			return ObjectIterator();
-		return _value.Map->begin();
+		return _value.Map.begin();
 	}
 
 	JsonObject::ObjectConstIterator JsonObject::ObjectConstBegin() const
 	{
 		if (GetType() != ValueType::Object)
 			return ObjectConstIterator();
-		return _value.Map->cbegin();
+		return _value.Map.cbegin();
 	}
 
 	JsonObject::ObjectIterator JsonObject::ObjectEnd()
 	{
+		Modified();
 		if (GetType() != ValueType::Object)
 			return ObjectIterator();
-		return _value.Map->end();
+		return _value.Map.end();
 	}
 
 	JsonObject::ObjectConstIterator JsonObject::ObjectConstEnd() const
 	{
 		if (GetType() != ValueType::Object)
 			return ObjectConstIterator();
-		return _value.Map->cend();
+		return _value.Map.cend();
 	}
 
 	JsonObject::ArrayIterator JsonObject::ArrayBegin()
 	{
+		Modified();
 		if (GetType() != ValueType::Array)
 			return ArrayIterator();
-		return _value.Array->begin();
+		Unpack();
+		return _value.Array.begin();
 	}
 
 	JsonObject::ArrayConstIterator JsonObject::ArrayConstBegin() const
 	{
 		if (GetType() != ValueType::Array)
 			return ArrayConstIterator();
-		return _value.Array->cbegin();
+		return ArrayConstIterator(this, 0);
 	}
 
 	JsonObject::ArrayIterator JsonObject::ArrayEnd()
 	{
+		Modified();
 		if (GetType() != ValueType::Array)
 			return ArrayIterator();
-		return _value.Array->end();
+		Unpack();
+		return _value.Array.end();
 	}
 
 	JsonObject::ArrayConstIterator JsonObject::ArrayConstEnd() const
 	{
 		if (GetType() != ValueType::Array)
 			return ArrayConstIterator();
-		return _value.Array->cend();
+		return ArrayConstIterator(this, length);
 	}
 
 	void JsonObject::Append(const JsonObject& object)
@@ -271,6 +573,7 @@ namespace Json
 
 	void JsonObject::Append(JsonObject&& object)
 	{
+		Modified();
 		ASSERT_TRUE((GetType() == ValueType::Array || GetType() == ValueType::Null),
 			"in JsonObject::Append: requires Array Value!");
 
@@ -278,27 +581,38 @@ namespace Json
 		if (GetType() == ValueType::Null)
 			*this = JsonObject(ValueType::Array);
 
-		_value.Array->emplace_back(std::move(object));
-	}
+		if (IsPackedArray() && PackedAccepts(object))
+		{
+			if ((flags & packedIntFlag) != 0)
+				_value.Int64s.emplace_back(object.AsInt64());
+			else
+				_value.Doubles.emplace_back(object._value.Double);
+			length++;
+			return;
+		}
 
-	int JsonObject::Size() const
-	{
-		if (GetType() == ValueType::Object)
-			return _value.Map->size();
-		else if (GetType() == ValueType::Array)
-			return _value.Array->size();
-		return 0;
+		Unpack();
+		_value.Array.emplace_back(std::move(object));
+		UpdateSize();
 	}
 
 	void JsonObject::Clear()
 	{
+		Modified();
 		switch (GetType())
 		{
 		case ValueType::Object:
-			_value.Map->clear();
+			_value.Map.clear();
+			length = 0;
 			break;
 		case ValueType::Array:
-			_value.Array->clear();
+			if ((flags & packedIntFlag) != 0)
+				_value.Int64s.clear();
+			else if ((flags & packedDoubleFlag) != 0)
+				_value.Doubles.clear();
+			else
+				_value.Array.clear();
+			length = 0;
 			break;
 		case ValueType::Null: break;
 		default:
@@ -307,8 +621,35 @@ namespace Json
 		}
 	}
 
+	void JsonObject::SetString(string_view value)
+	{
+		Modified();
+		if (ReuseText(value))
+			return;
+		*this = JsonObject(value);
+	}
+
+	void JsonObject::Reserve(unsigned int newCapacity)
+	{
+		Modified();
+		ASSERT_TRUE((GetType() == ValueType::Null || GetType() == ValueType::Array),
+			"in JsonObject::Reserve: requires Array Value!");
+
+		// If NullValue, then make ArrayValue.
+		if (GetType() == ValueType::Null)
+			(*this) = JsonObject(ValueType::Array);
+
+		if ((flags & packedIntFlag) != 0)
+			_value.Int64s.reserve(newCapacity);
+		else if ((flags & packedDoubleFlag) != 0)
+			_value.Doubles.reserve(newCapacity);
+		else
+			_value.Array.reserve(newCapacity);
+	}
+
 	void JsonObject::Resize(unsigned int newSize)
 	{
+		Modified();
 		ASSERT_TRUE((GetType() == ValueType::Null || GetType() == ValueType::Array),
 			"in JsonObject::Resize: requires Array Value!");
 
@@ -316,21 +657,17 @@ namespace Json
 		if (GetType() == ValueType::Null)
 			(*this) = JsonObject(ValueType::Array);
 
-		unsigned int oldSize = Size();
-		if (oldSize == newSize)
-			return;
-		else if (newSize == 0)
-			Clear();
-		else if (oldSize < newSize) // New size is greater, add items.
-		{
-			for (size_t i = oldSize; i < newSize; i++)
-				_value.Array->emplace_back(JsonObject(ValueType::Null));
-		}
-		else if (oldSize > newSize) // Old size is greater, remove items.
+		// Packed array can only shrink, added elements are null.
+		if ((flags & packedIntFlag) != 0 && newSize <= length)
+			_value.Int64s.resize(newSize);
+		else if ((flags & packedDoubleFlag) != 0 && newSize <= length)
+			_value.Doubles.resize(newSize);
+		else
 		{
-			for (size_t i = oldSize; i > newSize; i--)
-				_value.Array->pop_back();
+			Unpack();
+			_value.Array.resize(newSize);
 		}
+		length = newSize;
 	}
 
 	bool JsonObject::IsValidIndex(int index) const
@@ -348,6 +685,7 @@ namespace Json
 
 	bool JsonObject::Insert(int index, JsonObject&& object)
 	{
+		Modified();
 		ASSERT_TRUE((GetType() == ValueType::Array || GetType() == ValueType::Null),
 			"in JsonObject::Insert: requires Array Value!");
 
@@ -356,39 +694,56 @@ namespace Json
 
 		if (GetType() == ValueType::Null)
 			Append(std::move(object));
+		else if (IsPackedArray() && PackedAccepts(object))
+		{
+			if ((flags & packedIntFlag) != 0)
+				_value.Int64s.insert(_value.Int64s.cbegin() + index, object.AsInt64());
+			else
+				_value.Doubles.insert(_value.Doubles.cbegin() + index, double(object._value.Double));
+			length++;
+		}
 		else // Array
 		{
-			auto itr = _value.Array->cbegin() + index;
-			_value.Array->insert(itr, std::move(object));
+			Unpack();
+			auto itr = _value.Array.cbegin() + index;
+			_value.Array.insert(itr, std::move(object));
+			UpdateSize();
 		}
 		return true;
 	}
 
 	bool JsonObject::RemoveMember(const char* key, JsonObject* removed)
 	{
-		string sKey = key;
-		return RemoveMember(sKey, removed);
+		return RemoveMember(string_view(key), removed);
 	}
 
 	bool JsonObject::RemoveMember(const string& key, JsonObject* removed)
 	{
+		return RemoveMember(string_view(key), removed);
+	}
+
+	bool JsonObject::RemoveMember(string_view key, JsonObject* removed)
+	{
+		Modified();
 		ASSERT_TRUE((GetType() == ValueType::Null || GetType() == ValueType::Object),
 			"in JsonObject::RemoveMember: requires Object Value!");
 
 		if (GetType() == ValueType::Null)
 			return false;
 
-		auto itr = _value.Map->find(key);
-		if (itr == _value.Map->end()) // If not found.
+		auto itr = _value.Map.find(key);
+		if (itr == _value.Map.end()) // If not found.
 			return false;
 
 		removed = &(itr->second);
-		_value.Map->erase(itr);
+		_value.Map.erase(itr);
+		UpdateSize();
 		return true;
 	}
 
 	bool JsonObject::RemoveIndex(int index, JsonObject* removed)
 	{
+		Modified();
 		ASSERT_TRUE((GetType() == ValueType::Null || GetType() == ValueType::Array),
 			"in JsonObject::RemoveIndex: requires Array Value!");
 
@@ -397,20 +752,35 @@ namespace Json
 		if (!IsValidIndex(index))
 			return false;
 
-		auto itr = _value.Array->cbegin() + index;
-		if (itr == _value.Array->end())
+		if (IsPackedArray())
+		{
+			if ((flags & packedIntFlag) != 0)
+				_value.Int64s.erase(_value.Int64s.cbegin() + index);
+			else
+				_value.Doubles.erase(_value.Doubles.cbegin() + index);
+			length--;
+			return true;
+		}
+
+		auto itr = _value.Array.cbegin() + index;
+		if (itr == _value.Array.end())
 			return false;
-		_value.Array->erase(itr);
+		_value.Array.erase(itr);
+		UpdateSize();
 		return true;
 	}
 
 	bool JsonObject::IsMember(const char* key) const
 	{
-		string sKey = key;
-		return IsMember(sKey);
+		return IsMember(string_view(key));
 	}
 
 	bool JsonObject::IsMember(const string& key) const
+	{
+		return IsMember(string_view(key));
+	}
+
+	bool JsonObject::IsMember(string_view key) const
 	{
 		ASSERT_TRUE((GetType() == ValueType::Null || GetType() == ValueType::Object),
 			"in JsonObject::IsMember: requires Object Value!");
@@ -418,12 +788,23 @@ namespace Json
 		if (GetType() == ValueType::Null)
 			return false;
 
-		auto itr = _value.Map->find(key);
-		if (itr == _value.Map->end()) // If not found.
+		auto itr = _value.Map.find(key);
+		if (itr == _value.Map.end()) // If not found.
 			return false;
 		return true;
 	}
 
+	bool JsonObject::IsMember(const JsonKey& key) const
+	{
+		ASSERT_TRUE((GetType() == ValueType::Null || GetType() == ValueType::Object),
+			"in JsonObject::IsMember: requires Object Value!");
+
+		if (GetType() == ValueType::Null)
+			return false;
+
+		return _value.Map.find(key) != _value.Map.end();
+	}
+
 	vector<string> JsonObject::GetMemberNames() const
 	{
 		ASSERT_TRUE((GetType() == ValueType::Null || GetType() == ValueType::Object),
@@ -434,20 +815,23 @@ namespace Json
 			return vector<string>();
 
 		vector<string> names;
-		for (auto itr = _value.Map->cbegin(); itr != _value.Map->cend(); itr++)
-			names.push_back(itr->first);
+		names.reserve(length);
+		for (auto itr = _value.Map.cbegin(); itr != _value.Map.cend(); itr++)
+			names.push_back(itr->first.ToString());
 
 		return names;
 	}
 
-	bool JsonObject::IsIntegral(float value) const
+	bool JsonObject::IsIntegral(double value) const
 	{
-		float integralPart;
-		return modf(value, &integralPart) == 0.0f;
+		double integralPart;
+		return modf(value, &integralPart) == 0.0;
 	}
 
 	bool JsonObject::IsInt() const
 	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).IsInt();
 		switch (GetType())
 		{
 		case Json::ValueType::Int:
@@ -456,6 +840,12 @@ namespace Json
 			return _value.UInt <= INT_MAX;
 		case Json::ValueType::Float:
 			return _value.Float >= INT_MIN && _value.Float <= INT_MAX && IsIntegral(_value.Float);
+		case Json::ValueType::Int64:
+			return _value.Int64 >= INT_MIN && _value.Int64 <= INT_MAX;
+		case Json::ValueType::UInt64:
+			return _value.UInt64 <= INT_MAX;
+		case Json::ValueType::Double:
+			return _value.Double >= INT_MIN && _value.Double <= INT_MAX && IsIntegral(_value.Double);
 		default:
 			break;
 		}
@@ -464,14 +854,22 @@ namespace Json
 
 	bool JsonObject::IsUInt() const
 	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).IsUInt();
 		switch (GetType())
 		{
 		case ValueType::UInt:
 			return true;
 		case ValueType::Int:
-			return _value.UInt >= 0;
+			return _value.Int >= 0;
 		case ValueType::Float:
 			return _value.Float >= 0.0f && _value.Float <= UINT_MAX && IsIntegral(_value.Float);
+		case ValueType::Int64:
+			return _value.Int64 >= 0 && _value.Int64 <= UINT_MAX;
+		case ValueType::UInt64:
+			return _value.UInt64 <= UINT_MAX;
+		case ValueType::Double:
+			return _value.Double >= 0.0 && _value.Double <= UINT_MAX && IsIntegral(_value.Double);
 		default:
 			break;
 		}
@@ -480,35 +878,105 @@ namespace Json
 
 	bool JsonObject::IsFloat() const
 	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).IsFloat();
 		switch (GetType())
 		{
 		case ValueType::Float:
+		case ValueType::Int64:
+		case ValueType::UInt64:
 			return true;
 		case ValueType::Int:
 			return _value.Int >= -FLT_MAX && _value.Int <= FLT_MAX;
 		case ValueType::UInt:
 			return _value.UInt <= FLT_MAX;
+		case ValueType::Double:
+			return _value.Double >= -FLT_MAX && _value.Double <= FLT_MAX;
 		default:
 			break;
 		}
 		return false;
 	}
 
+	bool JsonObject::IsInt64() const
+	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).IsInt64();
+		switch (GetType())
+		{
+		case ValueType::Int:
+		case ValueType::UInt:
+		case ValueType::Int64:
+			return true;
+		case ValueType::UInt64:
+			return _value.UInt64 <= INT64_MAX;
+		case ValueType::Float:
+			// 2^63 is exactly representable, INT64_MAX is not.
+			return _value.Float >= -9223372036854775808.0f && _value.Float < 9223372036854775808.0f && IsIntegral(_value.Float);
+		case ValueType::Double:
+			return _value.Double >= -9223372036854775808.0 && _value.Double < 9223372036854775808.0 && IsIntegral(_value.Double);
+		default:
+			break;
+		}
+		return false;
+	}
+
+	bool JsonObject::IsUInt64() const
+	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).IsUInt64();
+		switch (GetType())
+		{
+		case ValueType::UInt:
+		case ValueType::UInt64:
+			return true;
+		case ValueType::Int:
+			return _value.Int >= 0;
+		case ValueType::Int64:
+			return _value.Int64 >= 0;
+		case ValueType::Float:
+			return _value.Float >= 0.0f && _value.Float < 18446744073709551616.0f && IsIntegral(_value.Float);
+		case ValueType::Double:
+			return _value.Double >= 0.0 && _value.Double < 18446744073709551616.0 && IsIntegral(_value.Double);
+		default:
+			break;
+		}
+		return false;
+	}
+
+	bool JsonObject::IsDouble() const
+	{
+		return IsNumeric();
+	}
+
 	bool JsonObject::IsNumeric() const
 	{
-		return GetType() == ValueType::Int || GetType() == ValueType::UInt || GetType() == ValueType::Float;
+		switch (GetType())
+		{
+		case ValueType::Int:
+		case ValueType::UInt:
+		case ValueType::Float:
+		case ValueType::Int64:
+		case ValueType::UInt64:
+		case ValueType::Double:
+			return true;
+		default:
+			return false;
+		}
 	}
 
 	bool JsonObject::IsConvertibleTo(ValueType otherType) const
 	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).IsConvertibleTo(otherType);
 		switch (otherType)
 		{
 		case ValueType::Null:
-			return (IsNumeric() && _value.Float == 0.0f) ||
+			return (IsNumeric() && AsDouble() == 0.0) ||
 				(GetType() == ValueType::Bool && !_value.Bool) ||
-				(GetType() == ValueType::String && AsString().empty()) ||
-				(GetType() == ValueType::Object && _value.Map->empty()) ||
-				(GetType() == ValueType::Array && _value.Array->empty()) ||
+				(GetType() == ValueType::String && length == 0) ||
+				(GetType() == ValueType::Object && length == 0) ||
+				(GetType() == ValueType::Array && length == 0) ||
 				(GetType() == ValueType::Null);
 		case ValueType::String:
 			return IsNumeric() ||
@@ -523,15 +991,26 @@ namespace Json
 			return IsInt() ||
 				(GetType() == ValueType::UInt && _value.UInt <= INT_MAX) ||
 				(GetType() == ValueType::Float && _value.Float >= INT_MIN && _value.Float <= INT_MAX) ||
+				(GetType() == ValueType::Double && _value.Double >= INT_MIN && _value.Double <= INT_MAX) ||
 				(GetType() == ValueType::Bool) ||
 				(GetType() == ValueType::Null);
 		case ValueType::UInt:
 			return IsUInt() ||
 				(GetType() == ValueType::Int && _value.Int >= 0) ||
 				(GetType() == ValueType::Float && _value.Float >= 0.0f && _value.Float <= UINT_MAX) ||
+				(GetType() == ValueType::Double && _value.Double >= 0.0 && _value.Double <= UINT_MAX) ||
+				(GetType() == ValueType::Bool) ||
+				(GetType() == ValueType::Null);
+		case ValueType::Int64:
+			return IsInt64() ||
+				(GetType() == ValueType::Bool) ||
+				(GetType() == ValueType::Null);
+		case ValueType::UInt64:
+			return IsUInt64() ||
 				(GetType() == ValueType::Bool) ||
 				(GetType() == ValueType::Null);
 		case ValueType::Float:
+		case ValueType::Double:
 			return IsNumeric() ||
 				(GetType() == ValueType::Bool) ||
 				(GetType() == ValueType::Null);
@@ -552,6 +1031,14 @@ namespace Json
 		return value;
 	}
 
+	string_view JsonObject::AsStringView() const
+	{
+		ASSERT_TRUE((GetType() == ValueType::String), "in JsonObject::AsStringView: requires StringValue!");
+		if (GetType() != ValueType::String || length == 0)
+			return string_view();
+		return string_view(StringData(), length);
+	}
+
 	bool JsonObject::AsBool() const
 	{
 		bool value;
@@ -584,6 +1071,30 @@ namespace Json
 		return value;
 	}
 
+	int64_t JsonObject::AsInt64() const
+	{
+		int64_t value;
+		bool succeed = AsInt64(value);
+		ASSERT_TRUE(succeed, "in JsonObject::AsInt64: Type is not convertible to int64.");
+		return value;
+	}
+
+	uint64_t JsonObject::AsUInt64() const
+	{
+		uint64_t value;
+		bool succeed = AsUInt64(value);
+		ASSERT_TRUE(succeed, "in JsonObject::AsUInt64: Type is not convertible to uint64.");
+		return value;
+	}
+
+	double JsonObject::AsDouble() const
+	{
+		double value;
+		bool succeed = AsDouble(value);
+		ASSERT_TRUE(succeed, "in JsonObject::AsDouble: Type is not convertible to double.");
+		return value;
+	}
+
 	bool JsonObject::AsString(string& value) const
 	{
 		switch (GetType())
@@ -592,10 +1103,10 @@ namespace Json
 			value = "null";
 			break;
 		case Json::ValueType::String:
-			if (_value.String == nullptr)
-				value = "";
+			if (length == 0)
+				value.clear();
 			else
-				value = _value.String;
+				value.assign(StringData(), length);
 			break;
 		case Json::ValueType::Bool:
 			value = _value.Bool ? "true" : "false";
@@ -609,6 +1120,27 @@ namespace Json
 		case Json::ValueType::Float:
 			value = std::to_string(_value.Float);
 			break;
+		case Json::ValueType::Int64:
+			value = std::to_string(_value.Int64);
+			break;
+		case Json::ValueType::UInt64:
+			value = std::to_string(_value.UInt64);
+			break;
+		case Json::ValueType::Double:
+		{
+			// Raw number is written as it was read.
+			if (IsRawNumber())
+			{
+				char buffer[rawInlineCapacity];
+				value.assign(RawToken(buffer));
+				break;
+			}
+			// Shortest text that reads back to the same double.
+			char buffer[32];
+			std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), _value.Double);
+			value.assign(buffer, result.ptr);
+			break;
+		}
 		case Json::ValueType::Object:
 		case Json::ValueType::Array:
 		default:
@@ -619,6 +1151,8 @@ namespace Json
 
 	bool JsonObject::AsBool(bool& value) const
 	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).AsBool(value);
 		switch (GetType())
 		{
 		case Json::ValueType::Null:
@@ -636,6 +1170,15 @@ namespace Json
 		case Json::ValueType::Float:
 			value = _value.Float;
 			break;
+		case Json::ValueType::Int64:
+			value = _value.Int64;
+			break;
+		case Json::ValueType::UInt64:
+			value = _value.UInt64;
+			break;
+		case Json::ValueType::Double:
+			value = _value.Double;
+			break;
 		case Json::ValueType::String:
 		case Json::ValueType::Object:
 		case Json::ValueType::Array:
@@ -647,6 +1190,8 @@ namespace Json
 
 	bool JsonObject::AsInt(int& value) const
 	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).AsInt(value);
 		switch (GetType())
 		{
 		case Json::ValueType::Null:
@@ -668,6 +1213,21 @@ namespace Json
 				return false;
 			value = static_cast<int>(_value.Float);
 			break;
+		case Json::ValueType::Int64:
+			if (!IsInt())
+				return false;
+			value = static_cast<int>(_value.Int64);
+			break;
+		case Json::ValueType::UInt64:
+			if (!IsInt())
+				return false;
+			value = static_cast<int>(_value.UInt64);
+			break;
+		case Json::ValueType::Double:
+			if (!IsInt())
+				return false;
+			value = static_cast<int>(_value.Double);
+			break;
 		case Json::ValueType::String:
 		case Json::ValueType::Object:
 		case Json::ValueType::Array:
@@ -679,6 +1239,8 @@ namespace Json
 
 	bool JsonObject::AsUInt(unsigned int& value) const
 	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).AsUInt(value);
 		switch (GetType())
 		{
 		case Json::ValueType::Null:
@@ -700,6 +1262,21 @@ namespace Json
 				return false;
 			value = static_cast<unsigned>(_value.Float);
 			break;
+		case Json::ValueType::Int64:
+			if (!IsUInt())
+				return false;
+			value = static_cast<unsigned>(_value.Int64);
+			break;
+		case Json::ValueType::UInt64:
+			if (!IsUInt())
+				return false;
+			value = static_cast<unsigned>(_value.UInt64);
+			break;
+		case Json::ValueType::Double:
+			if (!IsUInt())
+				return false;
+			value = static_cast<unsigned>(_value.Double);
+			break;
 		case Json::ValueType::String:
 		case Json::ValueType::Object:
 		case Json::ValueType::Array:
@@ -711,6 +1288,8 @@ namespace Json
 
 	bool JsonObject::AsFloat(float& value) const
 	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).AsFloat(value);
 		switch (GetType())
 		{
 		case Json::ValueType::Null:
@@ -732,6 +1311,151 @@ namespace Json
 		case Json::ValueType::Float:
 			value = _value.Float;
 			break;
+		case Json::ValueType::Int64:
+			value = static_cast<float>(_value.Int64);
+			break;
+		case Json::ValueType::UInt64:
+			value = static_cast<float>(_value.UInt64);
+			break;
+		case Json::ValueType::Double:
+			if (!IsFloat())
+				return false;
+			value = static_cast<float>(_value.Double);
+			break;
+		case Json::ValueType::String:
+		case Json::ValueType::Object:
+		case Json::ValueType::Array:
+		default:
+			return false;
+		}
+		return true;
+	}
+
+	bool JsonObject::AsInt64(int64_t& value) const
+	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).AsInt64(value);
+		switch (GetType())
+		{
+		case Json::ValueType::Null:
+			value = 0;
+			break;
+		case Json::ValueType::Bool:
+			value = _value.Bool;
+			break;
+		case Json::ValueType::Int:
+			value = _value.Int;
+			break;
+		case Json::ValueType::UInt:
+			value = _value.UInt;
+			break;
+		case Json::ValueType::Int64:
+			value = _value.Int64;
+			break;
+		case Json::ValueType::UInt64:
+			if (!IsInt64())
+				return false;
+			value = static_cast<int64_t>(_value.UInt64);
+			break;
+		case Json::ValueType::Float:
+			if (!IsInt64())
+				return false;
+			value = static_cast<int64_t>(_value.Float);
+			break;
+		case Json::ValueType::Double:
+			if (!IsInt64())
+				return false;
+			value = static_cast<int64_t>(_value.Double);
+			break;
+		case Json::ValueType::String:
+		case Json::ValueType::Object:
+		case Json::ValueType::Array:
+		default:
+			return false;
+		}
+		return true;
+	}
+
+	bool JsonObject::AsUInt64(uint64_t& value) const
+	{
+		if (IsRawNumber())
+			return JsonObject(RawNumberValue()).AsUInt64(value);
+		switch (GetType())
+		{
+		case Json::ValueType::Null:
+			value = 0;
+			break;
+		case Json::ValueType::Bool:
+			value = _value.Bool;
+			break;
+		case Json::ValueType::UInt:
+			value = _value.UInt;
+			break;
+		case Json::ValueType::UInt64:
+			value = _value.UInt64;
+			break;
+		case Json::ValueType::Int:
+			if (!IsUInt64())
+				return false;
+			value = static_cast<uint64_t>(_value.Int);
+			break;
+		case Json::ValueType::Int64:
+			if (!IsUInt64())
+				return false;
+			value = static_cast<uint64_t>(_value.Int64);
+			break;
+		case Json::ValueType::Float:
+			if (!IsUInt64())
+				return false;
+			value = static_cast<uint64_t>(_value.Float);
+			break;
+		case Json::ValueType::Double:
+			if (!IsUInt64())
+				return false;
+			value = static_cast<uint64_t>(_value.Double);
+			break;
+		case Json::ValueType::String:
+		case Json::ValueType::Object:
+		case Json::ValueType::Array:
+		default:
+			return false;
+		}
+		return true;
+	}
+
+	bool JsonObject::AsDouble(double& value) const
+	{
+		if (IsRawNumber())
+		{
+			value = RawNumberValue();
+			return true;
+		}
+		switch (GetType())
+		{
+		case Json::ValueType::Null:
+			value = 0.0;
+			break;
+		case Json::ValueType::Bool:
+			value = _value.Bool;
+			break;
+		case Json::ValueType::Int:
+			value = _value.Int;
+			break;
+		case Json::ValueType::UInt:
+			value = _value.UInt;
+			break;
+		case Json::ValueType::Float:
+			value = _value.Float;
+			break;
+		case Json::ValueType::Int64:
+			value = static_cast<double>(_value.Int64);
+			break;
+		case Json::ValueType::UInt64:
+			value = static_cast<double>(_value.UInt64);
+			break;
+		case Json::ValueType::Double:
+			value = _value.Double;
+			break;
 		case Json::ValueType::String:
 		case Json::ValueType::Object:
 		case Json::ValueType::Array:
@@ -741,29 +1465,303 @@ namespace Json
 		return true;
 	}
 
+	JsonArrayView<int64_t> JsonObject::AsInt64Array() const
+	{
+		if ((flags & packedIntFlag) == 0)
+			return JsonArrayView<int64_t>();
+		return JsonArrayView<int64_t>(_value.Int64s.data(), length);
+	}
+
+	JsonArrayView<double> JsonObject::AsDoubleArray() const
+	{
+		if ((flags & packedDoubleFlag) == 0)
+			return JsonArrayView<double>();
+		return JsonArrayView<double>(_value.Doubles.data(), length);
+	}
+
+	JsonObject JsonObject::ArenaContainer(ValueType type, std::pmr::memory_resource& arena)
+	{
+		JsonObject object;
+		object.type = type;
+		object.flags |= arenaFlag;
+		if (type == ValueType::Object)
+			object._value.Map = MemberMap::Create(&arena);
+		else
+			object._value.Array = ElementArray::Create(&arena);
+		return object;
+	}
+
+	void JsonObject::SetPackedArray(const int64_t* values, size_t count, std::pmr::memory_resource* arena)
+	{
+		Modified();
+		// Buffer of arena array may belong to an earlier arena, so it is not reused.
+		if (arena != nullptr || (flags & (packedIntFlag | arenaFlag)) != packedIntFlag)
+		{
+			*this = JsonObject(ValueType::Array);
+			flags = packedIntFlag | (arena != nullptr ? arenaFlag : 0);
+			_value.Int64s = JsonElementArray<int64_t>::Create(arena);
+		}
+		_value.Int64s.assign(values, count);
+		length = static_cast<uint32_t>(count);
+	}
+
+	void JsonObject::SetPackedArray(const double* values, size_t count, std::pmr::memory_resource* arena)
+	{
+		Modified();
+		if (arena != nullptr || (flags & (packedDoubleFlag | arenaFlag)) != packedDoubleFlag)
+		{
+			*this = JsonObject(ValueType::Array);
+			flags = packedDoubleFlag | (arena != nullptr ? arenaFlag : 0);
+			_value.Doubles = JsonElementArray<double>::Create(arena);
+		}
+		_value.Doubles.assign(values, count);
+		length = static_cast<uint32_t>(count);
+	}
+
+	JsonObject JsonObject::PackedElement(size_t index) const
+	{
+		if ((flags & packedDoubleFlag) != 0)
+			return JsonObject(_value.Doubles[index]);
+		return IntegerAsParsed(_value.Int64s[index]);
+	}
+
+	bool JsonObject::PackedAccepts(const JsonObject& value) const
+	{
+		if (value.IsRawNumber())
+			return false;
+		if ((flags & packedDoubleFlag) != 0)
+			return value.GetType() == ValueType::Double;
+
+		int64_t integer;
+		switch (value.GetType())
+		{
+		case ValueType::Int:
+			integer = value._value.Int;
+			break;
+		case ValueType::UInt:
+			integer = value._value.UInt;
+			break;
+		case ValueType::Int64:
+			integer = value._value.Int64;
+			break;
+		case ValueType::UInt64:
+			if (value._value.UInt64 > static_cast<uint64_t>(INT64_MAX))
+				return false;
+			integer = static_cast<int64_t>(value._value.UInt64);
+			break;
+		default:
+			return false;
+		}
+		// Otherwise it would read back as other integer type.
+		return IntegerAsParsed(integer).GetType() == value.GetType();
+	}
+
+	void JsonObject::Unpack()
+	{
+		if (!IsPackedArray())
+			return;
+
+		bool inArena = (flags & arenaFlag) != 0;
+		std::pmr::memory_resource* resource = (flags & packedIntFlag) != 0 ? _value.Int64s.get_resource() : _value.Doubles.get_resource();
+		ElementArray elements = ElementArray::Create(inArena ? resource : nullptr);
+		elements.reserve(length);
+		for (size_t i = 0; i < length; ++i)
+			elements.emplace_back(PackedElement(i));
+
+		// Buffer in arena is released with it.
+		if (!inArena && (flags & packedIntFlag) != 0)
+			_value.Int64s.Destroy();
+		else if (!inArena)
+			_value.Doubles.Destroy();
+		flags &= ~(packedIntFlag | packedDoubleFlag);
+		_value.Array = elements;
+	}
+
+	const JsonObject* JsonObject::PackedElements() const
+	{
+		// Readers on other threads may get here at once, the first one builds values under the lock.
+		// It also serializes allocations from arena, which are made only by modifying the document otherwise.
+		static std::mutex buildMutex;
+		bool isInt = (flags & packedIntFlag) != 0;
+		void* elements = isInt ? _value.Int64s.attached() : _value.Doubles.attached();
+		if (elements != nullptr)
+			return static_cast<const JsonObject*>(elements);
+
+		std::lock_guard<std::mutex> lock(buildMutex);
+		elements = isInt ? _value.Int64s.attached() : _value.Doubles.attached();
+		if (elements != nullptr)
+			return static_cast<const JsonObject*>(elements);
+		std::pmr::memory_resource* resource = isInt ? _value.Int64s.get_resource() : _value.Doubles.get_resource();
+		JsonObject* values = static_cast<JsonObject*>(resource->allocate(length * sizeof(JsonObject), alignof(JsonObject)));
+		for (size_t i = 0; i < length; ++i)
+			new (values + i) JsonObject(PackedElement(i));
+		if (isInt)
+			_value.Int64s.attach(values);
+		else
+			_value.Doubles.attach(values);
+		return values;
+	}
+
+	void JsonObject::ReleasePackedElements()
+	{
+		bool isInt = (flags & packedIntFlag) != 0;
+		void* elements = isInt ? _value.Int64s.detach() : _value.Doubles.detach();
+		if (elements == nullptr)
+			return;
+		// Values are numbers, they own no memory to release one by one.
+		std::pmr::memory_resource* resource = isInt ? _value.Int64s.get_resource() : _value.Doubles.get_resource();
+		resource->deallocate(elements, length * sizeof(JsonObject), alignof(JsonObject));
+	}
+
+	void JsonObject::Modified()
+	{
+		if (IsPackedArray())
+			ReleasePackedElements();
+		// Values holding this one may have cached their hashes, they are not reachable from here,
+		// so the next generation drops every cache. Nothing is written unless a hash was cached since the last one.
+		uint64_t current = hashGeneration.load(std::memory_order_relaxed);
+		while ((current & 1) != 0 &&
+			!hashGeneration.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	bool JsonObject::CachedHash(uint64_t& hash, uint64_t generation) const
+	{
+		if (type == ValueType::Object)
+			return _value.Map.cached_hash(hash, generation);
+		if (type != ValueType::Array)
+			return false;
+		if ((flags & packedIntFlag) != 0)
+			return _value.Int64s.cached_hash(hash, generation);
+		if ((flags & packedDoubleFlag) != 0)
+			return _value.Doubles.cached_hash(hash, generation);
+		return _value.Array.cached_hash(hash, generation);
+	}
+
 	void JsonObject::CleanUp()
 	{
-		if (type == ValueType::Object && _value.Map != nullptr)
-			delete _value.Map;
-		else if (type == ValueType::Array && _value.Array != nullptr)
-			delete _value.Array;
-		else if (type == ValueType::String && _value.String != nullptr)
+		// Arena releases the container and everything in it at once.
+		if ((flags & arenaFlag) != 0)
+			return;
+
+		if (IsPackedArray())
+			ReleasePackedElements();
+		if (type == ValueType::Object)
+			_value.Map.Destroy();
+		else if ((flags & packedIntFlag) != 0)
+			_value.Int64s.Destroy();
+		else if ((flags & packedDoubleFlag) != 0)
+			_value.Doubles.Destroy();
+		else if (type == ValueType::Array)
+			_value.Array.Destroy();
+		else if ((type == ValueType::String || IsRawNumber()) && (flags & (inlineFlag | borrowedFlag)) == 0 && _value.String != nullptr)
 			ReleaseStringValue(_value.String);
 	}
 
+	bool JsonObject::ReuseText(string_view value)
+	{
+		// Heap buffer is reused, so repeatedly set values do not reallocate.
+		if (type != ValueType::String || (flags & (inlineFlag | borrowedFlag)) != 0 ||
+			_value.String == nullptr || value.length() >= capacity)
+			return false;
+
+		// 'value' may be part of the current string.
+		memmove(_value.String, value.data(), value.length());
+		_value.String[value.length()] = '\0';
+		length = static_cast<uint32_t>(value.length());
+		return true;
+	}
+
+	void JsonObject::SetRawNumber(string_view token, bool borrow)
+	{
+		Modified();
+		// Heap buffer is reused like string ones, see 'ReuseText'.
+		if (!borrow && IsRawNumber() && (flags & (inlineFlag | borrowedFlag | arenaFlag)) == 0 && _value.String != nullptr &&
+			token.length() > rawInlineCapacity && token.length() < capacity)
+		{
+			memcpy(_value.String, token.data(), token.length());
+			_value.String[token.length()] = '\0';
+			length = static_cast<uint32_t>(token.length());
+			return;
+		}
+
+		// Set in place, numbers are most values of some documents.
+		CleanUp();
+		type = ValueType::Double;
+		flags = 0;
+		capacity = 0;
+		InitRawNumber(token, borrow);
+	}
+
+	double JsonObject::RawNumberValue() const
+	{
+		// Not cached, the object holds the token instead, and reading stays free of writes.
+		char buffer[rawInlineCapacity];
+		string_view token = RawToken(buffer);
+		double value = 0.0;
+		JsonNumberParser::ParseDouble(token.data(), token.data() + token.length(), value);
+		return value;
+	}
+
+	string_view JsonObject::RawToken(char* buffer) const
+	{
+		if ((flags & inlineFlag) == 0)
+			return string_view(_value.String, length);
+
+		uint64_t codes = _value.UInt64;
+		for (uint32_t i = 0; i < length; ++i, codes >>= 4)
+			buffer[i] = rawCharacters[codes & 0xF];
+		return string_view(buffer, length);
+	}
+
+	void JsonObject::InitRawNumber(string_view token, bool borrow)
+	{
+		flags |= rawFlag;
+		length = static_cast<uint32_t>(token.length());
+		if (token.length() <= rawInlineCapacity)
+		{
+			// Most tokens fit, so lazy numbers allocate no more than converted ones.
+			flags |= inlineFlag;
+			uint64_t codes = 0;
+			for (size_t i = token.length(); i-- > 0;)
+				codes = (codes << 4) | RawCode(token[i]);
+			_value.UInt64 = codes;
+		}
+		else if (borrow)
+		{
+			flags |= borrowedFlag;
+			// Cast is safe, borrowed characters are never written or released.
+			_value.String = const_cast<char*>(token.data());
+		}
+		else
+			_value.String = DublicateStringValue(token.data(), length);
+	}
+
+	void JsonObject::InitString(const char* value, uint32_t valueLength)
+	{
+		length = valueLength;
+		if (valueLength <= inlineCapacity)
+		{
+			flags |= inlineFlag;
+			if (valueLength != 0)
+				memcpy(_value.Inline, value, valueLength);
+		}
+		else
+			_value.String = DublicateStringValue(value, valueLength);
+	}
+
 	char* JsonObject::DublicateStringValue(const char* value, unsigned int length)
 	{
-		// Whether 'value' is null terminated or not.
-		bool isNullTerminated = (value[length - 1] == '\0') ? true : false;
-		char* newString = static_cast<char*>(malloc(length + (isNullTerminated ? 0U : 1U)));
+		char* newString = static_cast<char*>(malloc(length + 1));
 		ASSERT_TRUE((newString != nullptr), "Failed to allocate string value buffer");
 
 		// Copying memory of 'value' to 'newString'.
 		memcpy(newString, value, length);
 
-		// If not null terminated, then add '\0' to the end of it.
-		if (!isNullTerminated)
-			newString[length] = '\0';
+		// 'value' may be borrowed, so add '\0' to the end of it.
+		newString[length] = '\0';
+		capacity = length < UINT16_MAX ? static_cast<uint16_t>(length + 1) : 0;
 		return newString;
 	}
 
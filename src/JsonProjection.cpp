@@ -0,0 +1,151 @@
+#include "JsonProjection.h"
+#include <charconv>
+
+namespace Json
+{
+	JsonProjection::JsonProjection()
+		: nodes(1)
+	{
+	}
+
+	bool JsonProjection::AddPath(const string& path)
+	{
+		vector<string> steps;
+		if (!path.empty() && path[0] == '/')
+		{
+			// JSON Pointer, '~1' is '/' and '~0' is '~'.
+			string step;
+			for (size_t i = 1; i <= path.length(); ++i)
+			{
+				if (i == path.length() || path[i] == '/')
+				{
+					steps.push_back(step);
+					step.clear();
+				}
+				else if (path[i] == '~')
+				{
+					if (i + 1 == path.length() || (path[i + 1] != '0' && path[i + 1] != '1'))
+						return SetError("Invalid '~' escape in path: ", path);
+					step += path[++i] == '0' ? '~' : '/';
+				}
+				else
+					step += path[i];
+			}
+		}
+		else if (!path.empty())
+		{
+			// Dotted path, names are separated by '.', indices are in brackets.
+			size_t i = 0;
+			while (i < path.length())
+			{
+				if (path[i] == '[')
+				{
+					size_t close = path.find(']', i);
+					if (close == string::npos || close == i + 1)
+						return SetError("Invalid index in path: ", path);
+					string step = path.substr(i + 1, close - i - 1);
+					if (step != "*" && step.find_first_not_of("0123456789") != string::npos)
+						return SetError("Invalid index in path: ", path);
+					steps.push_back(step);
+					i = close + 1;
+				}
+				else
+				{
+					size_t stepEnd = path.find_first_of(".[", i);
+					if (stepEnd == string::npos)
+						stepEnd = path.length();
+					if (stepEnd == i)
+						return SetError("Empty name in path: ", path);
+					steps.push_back(path.substr(i, stepEnd - i));
+					i = stepEnd;
+				}
+
+				if (i < path.length() && path[i] == '.')
+				{
+					if (++i == path.length())
+						return SetError("Empty name in path: ", path);
+				}
+				else if (i < path.length() && path[i] != '[')
+					return SetError("Expected '.' or '[' in path: ", path);
+			}
+		}
+
+		size_t node = 0;
+		for (const string& step : steps)
+		{
+			// Nothing to add under a value that is built whole.
+			if (nodes[node].selected)
+				return true;
+			node = AddStep(node, step);
+		}
+		// Deeper paths are covered by this one.
+		nodes[node].selected = true;
+		nodes[node].children.clear();
+		nodes[node].wildcard = noNode;
+		nodes[node].elementCount = 0;
+		return true;
+	}
+
+	void JsonProjection::Clear()
+	{
+		nodes.assign(1, Node());
+		errorMessage.clear();
+	}
+
+	const JsonProjection::Node* JsonProjection::FindMember(const Node* node, string_view name) const
+	{
+		auto it = node->children.find(JsonString::Borrow(name.data(), name.length()));
+		if (it != node->children.end())
+			return &nodes[it->second];
+		if (node->wildcard != noNode)
+			return &nodes[node->wildcard];
+		return nullptr;
+	}
+
+	const JsonProjection::Node* JsonProjection::FindElement(const Node* node, size_t index) const
+	{
+		char digits[24];
+		char* digitsEnd = std::to_chars(digits, digits + sizeof(digits), index).ptr;
+		return FindMember(node, string_view(digits, digitsEnd - digits));
+	}
+
+	size_t JsonProjection::AddStep(size_t node, const string& step)
+	{
+		size_t child;
+		if (step == "*")
+		{
+			child = nodes[node].wildcard;
+			if (child == noNode)
+			{
+				child = nodes.size();
+				nodes[node].wildcard = child;
+				nodes.emplace_back();
+			}
+			return child;
+		}
+
+		auto it = nodes[node].children.find(JsonString::Borrow(step.data(), step.length()));
+		if (it != nodes[node].children.end())
+			return it->second;
+
+		// Step of digits without leading zero may be an element index, if the value turns out to be an array.
+		size_t index;
+		std::from_chars_result result = std::from_chars(step.data(), step.data() + step.length(), index);
+		bool isIndex = !step.empty() && result.ec == std::errc() && result.ptr == step.data() + step.length() &&
+			(step[0] != '0' || step.length() == 1);
+		if (isIndex && index >= nodes[node].elementCount)
+			nodes[node].elementCount = index + 1;
+
+		child = nodes.size();
+		nodes[node].children.emplace(JsonString(step), child);
+		nodes.emplace_back();
+		return child;
+	}
+
+	bool JsonProjection::SetError(const char* message, const string& path)
+	{
+		errorMessage = message;
+		errorMessage += path;
+		return false;
+	}
+}
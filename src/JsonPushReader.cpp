@@ -0,0 +1,312 @@
+#include "JsonPushReader.h"
+#include "JsonStringDecoder.h"
+#include "JsonNumberParser.h"
+#include <cstring>
+
+namespace Json
+{
+	namespace
+	{
+		inline bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+		}
+
+		inline bool IsStructural(char c)
+		{
+			return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+		}
+	}
+
+	bool JsonPushReader::Feed(const char* chunk, size_t length)
+	{
+		if (state == State::Error)
+			return false;
+
+		const char* current = chunk;
+		const char* end = chunk + length;
+		chunkBegin = position = chunk;
+
+		// Complete token left unfinished by previous chunk.
+		if (partialToken == PartialToken::String)
+		{
+			const char* quote = FindStringEnd(current, end, partialEscaped);
+			if (quote == nullptr)
+			{
+				partial.append(current, end);
+				consumed += length;
+				return true;
+			}
+			partial.append(current, quote + 1);
+			current = quote + 1;
+			partialToken = PartialToken::None;
+			if (!OnString(partial.data(), partial.data() + partial.length()))
+				return false;
+		}
+		else if (partialToken == PartialToken::Scalar)
+		{
+			const char* scalarEnd = FindScalarEnd(current, end);
+			partial.append(current, scalarEnd);
+			if (scalarEnd == end)
+			{
+				consumed += length;
+				return true;
+			}
+			current = scalarEnd;
+			partialToken = PartialToken::None;
+			if (!OnScalar(partial.data(), partial.data() + partial.length()))
+				return false;
+		}
+
+		while (current != end)
+		{
+			position = current;
+			char c = *current;
+			if (IsSpace(c))
+			{
+				++current;
+			}
+			else if (IsStructural(c))
+			{
+				if (!OnStructural(c))
+					return false;
+				++current;
+			}
+			else if (c == '"')
+			{
+				bool escaped = false;
+				const char* quote = FindStringEnd(current + 1, end, escaped);
+				if (quote == nullptr) // Split by chunk boundary.
+				{
+					partialToken = PartialToken::String;
+					partialEscaped = escaped;
+					partial.assign(current, end);
+					break;
+				}
+				if (!OnString(current, quote + 1))
+					return false;
+				current = quote + 1;
+			}
+			else
+			{
+				const char* scalarEnd = FindScalarEnd(current, end);
+				if (scalarEnd == end) // May continue in the next chunk.
+				{
+					partialToken = PartialToken::Scalar;
+					partial.assign(current, end);
+					break;
+				}
+				if (!OnScalar(current, scalarEnd))
+					return false;
+				current = scalarEnd;
+			}
+		}
+
+		consumed += length;
+		return true;
+	}
+
+	bool JsonPushReader::Finish()
+	{
+		if (state == State::Error)
+			return false;
+
+		chunkBegin = position = nullptr;
+		// Number/literal at the very end of input is complete now.
+		if (partialToken == PartialToken::Scalar)
+		{
+			partialToken = PartialToken::None;
+			if (!OnScalar(partial.data(), partial.data() + partial.length()))
+				return false;
+		}
+		if (partialToken == PartialToken::String)
+			return SetError("Unexpected end of string.");
+		if (state != State::Done)
+			return SetError("Unexpected end of JSON text.");
+		return true;
+	}
+
+	void JsonPushReader::Reset()
+	{
+		state = State::ExpectRoot;
+		stack.clear();
+		// Root is kept, next document is written over it.
+		handler.Reset();
+		partialToken = PartialToken::None;
+		partialEscaped = false;
+		partial.clear();
+		consumed = 0;
+		chunkBegin = position = nullptr;
+		errorOffset = 0;
+		errorMessage.clear();
+	}
+
+	string JsonPushReader::GetErrorMessage() const
+	{
+		if (errorMessage.empty())
+			return "";
+
+		return "Error at byte " + std::to_string(errorOffset) + ": " + errorMessage + '\n';
+	}
+
+	bool JsonPushReader::OnStructural(char c)
+	{
+		switch (c)
+		{
+		case '{':
+		case '[':
+			if (state != State::ExpectRoot && state != State::ExpectValue && state != State::ExpectFirstElementOrEnd)
+				return SetError("Syntax error: Unexpected token.");
+			if (stack.size() >= maxDepth)
+				return SetError("Maximum nesting depth exceeded.");
+
+			if (!(c == '{' ? handler.StartObject() : handler.StartArray()))
+				return SetError("Parsing stopped by handler.");
+			stack.push_back(Frame{ c == '{', 0 });
+			state = c == '{' ? State::ExpectFirstMemberOrEnd : State::ExpectFirstElementOrEnd;
+			return true;
+		case '}':
+		case ']':
+		{
+			bool isObjectEnd = c == '}';
+			bool canEnd = state == State::ExpectCommaOrEnd ||
+				(isObjectEnd ? state == State::ExpectFirstMemberOrEnd : state == State::ExpectFirstElementOrEnd);
+			if (!canEnd || stack.back().isObject != isObjectEnd)
+				return SetError(isObjectEnd ? "Missing ',' or '}' after object member value." : "Missing ',' or ']' after array value.");
+
+			size_t count = stack.back().count;
+			stack.pop_back();
+			if (!(isObjectEnd ? handler.EndObject(count) : handler.EndArray(count)))
+				return SetError("Parsing stopped by handler.");
+			OnValue();
+			return true;
+		}
+		case ':':
+			if (state != State::ExpectColon)
+				return SetError("Syntax error: Unexpected token.");
+			state = State::ExpectValue;
+			return true;
+		case ',':
+			if (state != State::ExpectCommaOrEnd)
+				return SetError("Syntax error: Unexpected token.");
+			state = stack.back().isObject ? State::ExpectMemberName : State::ExpectValue;
+			return true;
+		default:
+			return SetError("Syntax error: Unexpected token.");
+		}
+	}
+
+	bool JsonPushReader::OnString(const char* start, const char* end)
+	{
+		decodeBuffer.clear();
+		if (!JsonStringDecoder::Decode(start + 1, end - 1, decodeBuffer)) // Skip '"'s
+			return SetError("Invalid escape sequence or character in string.");
+
+		if (state == State::ExpectFirstMemberOrEnd || state == State::ExpectMemberName)
+		{
+			if (!handler.Key(decodeBuffer))
+				return SetError("Parsing stopped by handler.");
+			state = State::ExpectColon;
+			return true;
+		}
+		if (state != State::ExpectValue && state != State::ExpectFirstElementOrEnd)
+			return SetError(state == State::ExpectRoot ?
+				"A valid JSON document must be either an array or an object value." : "Syntax error: Unexpected token.");
+
+		if (!handler.String(decodeBuffer))
+			return SetError("Parsing stopped by handler.");
+		OnValue();
+		return true;
+	}
+
+	bool JsonPushReader::OnScalar(const char* start, const char* end)
+	{
+		if (state != State::ExpectValue && state != State::ExpectFirstElementOrEnd)
+			return SetError(state == State::ExpectRoot ?
+				"A valid JSON document must be either an array or an object value." : "Syntax error: Unexpected token.");
+
+		size_t length = end - start;
+		bool succeed;
+		if (length == 4 && memcmp(start, "true", 4) == 0)
+			succeed = handler.Bool(true);
+		else if (length == 5 && memcmp(start, "false", 5) == 0)
+			succeed = handler.Bool(false);
+		else if (length == 4 && memcmp(start, "null", 4) == 0)
+			succeed = handler.Null();
+		else
+		{
+			JsonNumberParser::Number number;
+			if (!JsonNumberParser::Parse(start, end, number))
+				return SetError("Invalid number.");
+			switch (number.type)
+			{
+			case ValueType::Int: succeed = handler.Int(static_cast<int>(number.Int64)); break;
+			case ValueType::UInt: succeed = handler.UInt(static_cast<unsigned int>(number.UInt64)); break;
+			case ValueType::Int64: succeed = handler.Int64(number.Int64); break;
+			case ValueType::UInt64: succeed = handler.UInt64(number.UInt64); break;
+			default: succeed = handler.Double(number.Double); break;
+			}
+		}
+		if (!succeed)
+			return SetError("Parsing stopped by handler.");
+		OnValue();
+		return true;
+	}
+
+	void JsonPushReader::OnValue()
+	{
+		if (stack.empty())
+		{
+			state = State::Done;
+			return;
+		}
+
+		stack.back().count++;
+		state = State::ExpectCommaOrEnd;
+	}
+
+	const char* JsonPushReader::FindStringEnd(const char* current, const char* end, bool& escaped) const
+	{
+		// Character right after chunk boundary may be escaped.
+		if (escaped && current != end)
+		{
+			escaped = false;
+			++current;
+		}
+		while (current != end)
+		{
+			const char* stop = current;
+			while (stop != end && *stop != '"' && *stop != '\\')
+				++stop;
+			if (stop == end)
+				return nullptr;
+			if (*stop == '"')
+				return stop;
+
+			// Skip backslash and the escaped character.
+			if (stop + 1 == end)
+			{
+				escaped = true;
+				return nullptr;
+			}
+			current = stop + 2;
+		}
+		return nullptr;
+	}
+
+	const char* JsonPushReader::FindScalarEnd(const char* current, const char* end) const
+	{
+		while (current != end && !IsSpace(*current) && !IsStructural(*current) && *current != '"')
+			++current;
+		return current;
+	}
+
+	bool JsonPushReader::SetError(const char* message)
+	{
+		errorOffset = consumed + (position != nullptr ? position - chunkBegin : 0);
+		errorMessage = message;
+		state = State::Error;
+		handler.Discard();
+		return false;
+	}
+}
@@ -0,0 +1,585 @@
+#include "JsonQuery.h"
+#include "JsonDomHandler.h"
+#include "JsonNumberParser.h"
+#include "JsonReader.h"
+#include <charconv>
+
+namespace Json
+{
+	namespace
+	{
+		inline bool IsSpace(char c)
+		{
+			return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+		}
+
+		inline void SkipSpaces(string_view path, size_t& position)
+		{
+			while (position < path.length() && IsSpace(path[position]))
+				++position;
+		}
+
+		/** Returns true if 'c' can be part of a name not in brackets. */
+		inline bool IsNameChar(char c)
+		{
+			return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+				c == '_' || c == '-' || c == '$' || static_cast<unsigned char>(c) >= 0x80;
+		}
+
+		inline bool StartsWith(string_view path, size_t position, string_view prefix)
+		{
+			return path.substr(position, prefix.length()) == prefix;
+		}
+	}
+
+	/** Reader event handler running 'JsonQuery' over text.
+	*	Follows name, index and wildcard steps event by event, and builds
+	*	only values that complete the query or are tested by a filter,
+	*	which are then finished by walking them. */
+	class JsonQuery::StreamHandler
+	{
+	public:
+		StreamHandler(const JsonQuery& query, const std::function<bool(const JsonObject&)>& onMatch)
+			: query(query), onMatch(onMatch)
+		{
+		}
+
+		bool Null() { return depth != 0 ? capture.Null() : Scalar(JsonObject()); }
+		bool Bool(bool value) { return depth != 0 ? capture.Bool(value) : Scalar(JsonObject(value)); }
+		bool Int(int value) { return depth != 0 ? capture.Int(value) : Scalar(JsonObject(value)); }
+		bool UInt(unsigned int value) { return depth != 0 ? capture.UInt(value) : Scalar(JsonObject(value)); }
+		bool Int64(int64_t value) { return depth != 0 ? capture.Int64(value) : Scalar(JsonObject(value)); }
+		bool UInt64(uint64_t value) { return depth != 0 ? capture.UInt64(value) : Scalar(JsonObject(value)); }
+		bool Double(double value) { return depth != 0 ? capture.Double(value) : Scalar(JsonObject(value)); }
+		bool String(string_view value) { return depth != 0 ? capture.String(value) : Scalar(JsonObject(value)); }
+
+		bool Key(string_view key)
+		{
+			if (depth != 0)
+				return capture.Key(key);
+			memberTarget = ChildTarget(stack.back().step, key, noIndex, true);
+			return true;
+		}
+
+		bool StartObject() { return StartContainer(true); }
+		bool StartArray() { return StartContainer(false); }
+
+		bool EndObject(size_t memberCount)
+		{
+			if (depth == 0)
+			{
+				stack.pop_back();
+				return true;
+			}
+			capture.EndObject(memberCount);
+			return --depth != 0 || Finish(captureTarget, captured);
+		}
+
+		bool EndArray(size_t elementCount)
+		{
+			if (depth == 0)
+			{
+				stack.pop_back();
+				return true;
+			}
+			capture.EndArray(elementCount);
+			return --depth != 0 || Finish(captureTarget, captured);
+		}
+
+	private:
+		static constexpr size_t skipStep = static_cast<size_t>(-1);
+
+		// Step a value is matched against, 'skipStep' if it can't be selected.
+		struct Target
+		{
+			size_t step;
+			// Value has to pass filter of 'step' first.
+			bool filtered;
+		};
+
+		// Open container outside of built values, and step its children are matched against.
+		struct Frame
+		{
+			bool isObject;
+			size_t step;
+			int64_t index;
+		};
+
+		/** Returns target of the value beginning now. */
+		Target NextTarget()
+		{
+			if (stack.empty())
+				return Target{ 0, false };
+			Frame& frame = stack.back();
+			if (frame.isObject)
+				return memberTarget;
+			return ChildTarget(frame.step, string_view(), frame.index++, false);
+		}
+
+		/** Returns target of member 'name' or element 'index' of container matched against 'step'. */
+		Target ChildTarget(size_t step, string_view name, int64_t index, bool inObject) const
+		{
+			if (step == skipStep)
+				return Target{ skipStep, false };
+
+			const Step& current = query.steps[step];
+			bool isMatch = false;
+			switch (current.type)
+			{
+			case StepType::Name:
+				isMatch = inObject ? current.key.View() == name : current.index == index;
+				break;
+			case StepType::Index:
+				isMatch = !inObject && current.index == index;
+				break;
+			case StepType::Wildcard:
+				isMatch = true;
+				break;
+			case StepType::Filter:
+				return Target{ step, true };
+			}
+			return Target{ isMatch ? step + 1 : skipStep, false };
+		}
+
+		/** Return true if value of 'target' is built and finished by walking it. */
+		bool NeedsValue(const Target& target) const
+		{
+			if (target.step == skipStep)
+				return false;
+			// Elements counted from the end are known only once the array ends.
+			return target.filtered || target.step == query.steps.size() ||
+				(query.steps[target.step].type == StepType::Index && query.steps[target.step].index < 0);
+		}
+
+		bool Scalar(JsonObject&& value)
+		{
+			Target target = NextTarget();
+			return !NeedsValue(target) || Finish(target, value);
+		}
+
+		bool StartContainer(bool isObject)
+		{
+			if (depth != 0)
+			{
+				++depth;
+				return isObject ? capture.StartObject() : capture.StartArray();
+			}
+
+			Target target = NextTarget();
+			if (NeedsValue(target))
+			{
+				// Build the value, reusing memory of the previous one.
+				captureTarget = target;
+				depth = 1;
+				capture.Reset(captured);
+				return isObject ? capture.StartObject() : capture.StartArray();
+			}
+			stack.push_back(Frame{ isObject, target.step, 0 });
+			return true;
+		}
+
+		bool Finish(const Target& target, const JsonObject& value)
+		{
+			auto visitor = [this](const JsonObject& match) { return onMatch(match); };
+			if (target.filtered)
+				return !query.Matches(value, query.steps[target.step]) || query.Walk(value, target.step + 1, visitor);
+			return query.Walk(value, target.step, visitor);
+		}
+
+	private:
+		const JsonQuery& query;
+		const std::function<bool(const JsonObject&)>& onMatch;
+		vector<Frame> stack;
+		// Target of the member named by last 'Key'.
+		Target memberTarget = Target{ skipStep, false };
+
+		// Value being built, and how deep in it the parser is.
+		JsonObject captured;
+		JsonDomHandler capture;
+		Target captureTarget = Target{ skipStep, false };
+		size_t depth = 0;
+	};
+
+	JsonQuery::JsonQuery(const JsonQuery& other)
+		: steps(other.steps), filterSteps(other.filterSteps), filters(other.filters),
+		names(other.names), errorMessage(other.errorMessage)
+	{
+		BindKeys();
+	}
+
+	JsonQuery& JsonQuery::operator=(const JsonQuery& other)
+	{
+		JsonQuery copy(other);
+		return *this = std::move(copy);
+	}
+
+	JsonQuery JsonQuery::Compile(string_view path)
+	{
+		JsonQuery query;
+		size_t position = 1;
+		if (path.empty() || path[0] != '$')
+			query.SetError("JSONPath must begin with '$': ", path);
+		else if (query.ParsePath(path, position, query.steps, false) && position != path.length())
+			query.SetError("Expected '.' or '[' in path: ", path);
+		query.BindKeys();
+		return query;
+	}
+
+	JsonQuery JsonQuery::CompilePointer(string_view pointer)
+	{
+		JsonQuery query;
+		if (!pointer.empty() && pointer[0] != '/')
+		{
+			query.SetError("JSON Pointer must begin with '/': ", pointer);
+			return query;
+		}
+
+		// '~1' is '/' and '~0' is '~'.
+		string token;
+		for (size_t i = 1; i <= pointer.length() && !pointer.empty(); ++i)
+		{
+			if (i == pointer.length() || pointer[i] == '/')
+			{
+				// Index is "0" or digits without leading zero, it also names a member.
+				int64_t index = noIndex;
+				bool isIndex = !token.empty() && token.find_first_not_of("0123456789") == string::npos &&
+					(token[0] != '0' || token.length() == 1);
+				if (isIndex && std::from_chars(token.data(), token.data() + token.length(), index).ec != std::errc())
+					index = noIndex;
+				query.steps.push_back(query.MakeName(token, index));
+				token.clear();
+			}
+			else if (pointer[i] == '~')
+			{
+				if (i + 1 == pointer.length() || (pointer[i + 1] != '0' && pointer[i + 1] != '1'))
+				{
+					query.SetError("Invalid '~' escape in pointer: ", pointer);
+					return query;
+				}
+				token += pointer[++i] == '0' ? '~' : '/';
+			}
+			else
+				token += pointer[i];
+		}
+		query.BindKeys();
+		return query;
+	}
+
+	size_t JsonQuery::Select(const JsonObject& root, vector<const JsonObject*>& matches) const
+	{
+		size_t count = 0;
+		ForEach(root, [&](const JsonObject& match)
+		{
+			matches.push_back(&match);
+			++count;
+			return true;
+		});
+		return count;
+	}
+
+	const JsonObject* JsonQuery::SelectFirst(const JsonObject& root) const
+	{
+		const JsonObject* first = nullptr;
+		ForEach(root, [&](const JsonObject& match)
+		{
+			first = &match;
+			return false;
+		});
+		return first;
+	}
+
+	bool JsonQuery::Stream(JsonReader& reader, const char* beginText, const char* endText,
+		const std::function<bool(const JsonObject&)>& onMatch) const
+	{
+		if (!IsValid())
+			return false;
+		StreamHandler handler(*this, onMatch);
+		return reader.Parse(beginText, endText, handler);
+	}
+
+	bool JsonQuery::Stream(JsonReader& reader, const string& json,
+		const std::function<bool(const JsonObject&)>& onMatch) const
+	{
+		return Stream(reader, json.data(), json.data() + json.length(), onMatch);
+	}
+
+	const JsonObject* JsonQuery::Child(const JsonObject& value, const Step& step)
+	{
+		if (step.type == StepType::Name && value.IsObject())
+		{
+			auto it = value._value.Map.find(step.key);
+			return it != value._value.Map.end() ? &it->second : nullptr;
+		}
+		if (!value.IsArray() || step.index == noIndex)
+			return nullptr;
+
+		int64_t index = step.index < 0 ? step.index + value.Size() : step.index;
+		if (index < 0 || index >= value.Size())
+			return nullptr;
+		return &value[static_cast<int>(index)];
+	}
+
+	bool JsonQuery::Matches(const JsonObject& value, const Step& step) const
+	{
+		const Filter& filter = filters[step.filter];
+		const JsonObject* operand = &value;
+		for (size_t i = filter.pathBegin; i < filter.pathEnd && operand != nullptr; ++i)
+			operand = Child(*operand, filterSteps[i]);
+		if (operand == nullptr)
+			return false;
+		if (filter.op == FilterOperator::Exists)
+			return true;
+
+		int order;
+		if (operand->IsNumeric() && filter.literal.IsNumeric())
+		{
+			double left = operand->AsDouble(), right = filter.literal.AsDouble();
+			order = left < right ? -1 : (left > right ? 1 : 0);
+		}
+		else if (operand->IsString() && filter.literal.IsString())
+		{
+			int compared = operand->AsStringView().compare(filter.literal.AsStringView());
+			order = compared < 0 ? -1 : (compared > 0 ? 1 : 0);
+		}
+		else
+		{
+			// Other values are only equal or not, values of different types are never equal.
+			bool isEqual = operand->GetType() == filter.literal.GetType() && *operand == filter.literal;
+			return filter.op == FilterOperator::Equal ? isEqual : (filter.op == FilterOperator::NotEqual && !isEqual);
+		}
+
+		switch (filter.op)
+		{
+		case FilterOperator::Equal:
+			return order == 0;
+		case FilterOperator::NotEqual:
+			return order != 0;
+		case FilterOperator::Less:
+			return order < 0;
+		case FilterOperator::LessEqual:
+			return order <= 0;
+		case FilterOperator::Greater:
+			return order > 0;
+		case FilterOperator::GreaterEqual:
+			return order >= 0;
+		default:
+			return false;
+		}
+	}
+
+	bool JsonQuery::ParsePath(string_view path, size_t& position, vector<Step>& parsedSteps, bool isRelative)
+	{
+		while (position < path.length())
+		{
+			if (path[position] == '.')
+			{
+				++position;
+				if (position < path.length() && path[position] == '.')
+					return SetError("Recursive descent '..' is not supported: ", path);
+				if (!isRelative && position < path.length() && path[position] == '*')
+				{
+					++position;
+					parsedSteps.push_back(Step{ StepType::Wildcard });
+					continue;
+				}
+
+				size_t nameBegin = position;
+				while (position < path.length() && IsNameChar(path[position]))
+					++position;
+				if (position == nameBegin)
+					return SetError("Empty name in path: ", path);
+				parsedSteps.push_back(MakeName(path.substr(nameBegin, position - nameBegin), noIndex));
+			}
+			else if (path[position] == '[')
+			{
+				++position;
+				SkipSpaces(path, position);
+				if (position == path.length())
+					return SetError("Unexpected end of path: ", path);
+
+				char c = path[position];
+				if (c == '*' && !isRelative)
+				{
+					++position;
+					parsedSteps.push_back(Step{ StepType::Wildcard });
+				}
+				else if (c == '?' && !isRelative)
+				{
+					++position;
+					if (!ParseFilter(path, position))
+						return false; // Error already set.
+				}
+				else if (c == '\'' || c == '"')
+				{
+					string name;
+					if (!ParseQuoted(path, position, name))
+						return false; // Error already set.
+					parsedSteps.push_back(MakeName(name, noIndex));
+				}
+				else
+				{
+					Step step{ StepType::Index };
+					std::from_chars_result result = std::from_chars(path.data() + position, path.data() + path.length(), step.index);
+					if (result.ec != std::errc() || step.index == noIndex)
+						return SetError("Invalid selector in path: ", path);
+					position = result.ptr - path.data();
+					parsedSteps.push_back(step);
+				}
+
+				SkipSpaces(path, position);
+				if (position == path.length() || path[position] != ']')
+					return SetError("Missing ']' in path: ", path);
+				++position;
+			}
+			else if (isRelative)
+				return true; // Rest of the filter follows.
+			else
+				return SetError("Expected '.' or '[' in path: ", path);
+		}
+		return true;
+	}
+
+	bool JsonQuery::ParseFilter(string_view path, size_t& position)
+	{
+		// Filter steps are only in 'steps', relative paths can't have them.
+		SkipSpaces(path, position);
+		if (position == path.length() || path[position] != '(')
+			return SetError("Expected '(' after '?' in path: ", path);
+		++position;
+		SkipSpaces(path, position);
+		if (position == path.length() || path[position] != '@')
+			return SetError("Filter must begin with '@': ", path);
+		++position;
+
+		Filter filter{ filterSteps.size(), 0, FilterOperator::Exists, JsonObject() };
+		if (!ParsePath(path, position, filterSteps, true))
+			return false; // Error already set.
+		filter.pathEnd = filterSteps.size();
+
+		SkipSpaces(path, position);
+		if (position < path.length() && path[position] != ')')
+		{
+			// Longer operators are matched first.
+			static const struct { string_view text; FilterOperator op; } operators[] =
+			{
+				{ "==", FilterOperator::Equal }, { "!=", FilterOperator::NotEqual },
+				{ "<=", FilterOperator::LessEqual }, { ">=", FilterOperator::GreaterEqual },
+				{ "<", FilterOperator::Less }, { ">", FilterOperator::Greater }
+			};
+			bool isFound = false;
+			for (const auto& candidate : operators)
+			{
+				if (StartsWith(path, position, candidate.text))
+				{
+					filter.op = candidate.op;
+					position += candidate.text.length();
+					isFound = true;
+					break;
+				}
+			}
+			if (!isFound)
+				return SetError("Invalid operator in filter: ", path);
+
+			SkipSpaces(path, position);
+			if (!ParseLiteral(path, position, filter.literal))
+				return false; // Error already set.
+			SkipSpaces(path, position);
+		}
+		if (position == path.length() || path[position] != ')')
+			return SetError("Missing ')' in filter: ", path);
+		++position;
+
+		Step step{ StepType::Filter };
+		step.filter = filters.size();
+		steps.push_back(step);
+		filters.push_back(std::move(filter));
+		return true;
+	}
+
+	bool JsonQuery::ParseLiteral(string_view path, size_t& position, JsonObject& literal)
+	{
+		if (position == path.length())
+			return SetError("Missing literal in filter: ", path);
+
+		char c = path[position];
+		if (c == '\'' || c == '"')
+		{
+			string value;
+			if (!ParseQuoted(path, position, value))
+				return false; // Error already set.
+			literal = JsonObject(value);
+			return true;
+		}
+
+		static const struct { string_view text; bool isNull; bool value; } keywords[] =
+		{
+			{ "true", false, true }, { "false", false, false }, { "null", true, false }
+		};
+		for (const auto& keyword : keywords)
+		{
+			if (StartsWith(path, position, keyword.text))
+			{
+				literal = keyword.isNull ? JsonObject() : JsonObject(keyword.value);
+				position += keyword.text.length();
+				return true;
+			}
+		}
+
+		size_t numberBegin = position;
+		while (position < path.length() && (IsNameChar(path[position]) || path[position] == '.' || path[position] == '+'))
+			++position;
+		if (!JsonNumberParser::Parse(path.data() + numberBegin, path.data() + position, literal))
+			return SetError("Invalid literal in filter: ", path);
+		return true;
+	}
+
+	bool JsonQuery::ParseQuoted(string_view path, size_t& position, string& value)
+	{
+		char quote = path[position++];
+		value.clear();
+		while (position < path.length())
+		{
+			char c = path[position++];
+			if (c == quote)
+				return true;
+			// Backslash takes the next character as is, such as a quote.
+			if (c == '\\' && position < path.length())
+				c = path[position++];
+			value += c;
+		}
+		return SetError("Unterminated string in path: ", path);
+	}
+
+	JsonQuery::Step JsonQuery::MakeName(string_view name, int64_t index)
+	{
+		Step step{ StepType::Name };
+		step.nameOffset = static_cast<uint32_t>(names.size());
+		step.nameLength = static_cast<uint32_t>(name.length());
+		step.index = index;
+		names.insert(names.end(), name.begin(), name.end());
+		return step;
+	}
+
+	void JsonQuery::BindKeys()
+	{
+		for (vector<Step>* stepList : { &steps, &filterSteps })
+		{
+			for (Step& step : *stepList)
+			{
+				if (step.type == StepType::Name)
+					step.key = JsonKey(string_view(names.data() + step.nameOffset, step.nameLength));
+			}
+		}
+	}
+
+	bool JsonQuery::SetError(const char* message, string_view path)
+	{
+		// Query selects nothing.
+		steps.clear();
+		filterSteps.clear();
+		filters.clear();
+		errorMessage = message;
+		errorMessage += path;
+		return false;
+	}
+}
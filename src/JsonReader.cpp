@@ -1,9 +1,23 @@
 #include "JsonReader.h"
-#include <sstream>
+#include "JsonDomHandler.h"
+#include "JsonStringDecoder.h"
+#include "JsonMappedFile.h"
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
 namespace Json
 {
+	namespace
+	{
+		// Smallest text parsed in parallel, and bounds of one piece given to a thread.
+		constexpr size_t parallelMinSize = size_t(4) << 20;
+		constexpr size_t minPieceSize = size_t(1) << 20;
+		constexpr size_t maxPieceSize = size_t(256) << 20;
+	}
+
 	bool JsonReader::Parse(const string& json, JsonObject& root)
 	{
 		const char* begin = json.c_str();
@@ -19,12 +33,48 @@ namespace Json
 	}
 
 	bool JsonReader::Parse(const char* beginText, const char* endText, JsonObject& root)
+	{
+		domHandler.SetKeyTable(keyTable);
+		if (threadCount != 1 && projection == nullptr && keyTable == nullptr && maxDepth > 1 &&
+			static_cast<size_t>(endText - beginText) >= parallelMinSize)
+			return ParseArrayInParallel(beginText, endText, root);
+
+		domHandler.Reset(root, inSitu);
+		if (Parse(beginText, endText, domHandler))
+			return true;
+		domHandler.Discard();
+		return false;
+	}
+
+	bool JsonReader::ParseInSitu(char* beginText, char* endText, JsonObject& root)
+	{
+		inSitu = true;
+		bool succeed = Parse(beginText, endText, root);
+		inSitu = false;
+		return succeed;
+	}
+
+	bool JsonReader::BeginParse(const char* beginText, const char* endText)
 	{
 		current = begin = beginText;
 		end = endText;
+		bytesSkipped = 0;
+
+		if (mode == ReaderMode::Structural)
+		{
+			structuralPosition = 0;
+			if (!indexer.Index(begin, end, structuralIndex))
+			{
+				Token token;
+				token.type = TokenType::tokenError;
+				token.start = begin;
+				token.end = end;
+				return SetError("JSON text is too large for structural mode.", token);
+			}
+		}
 
 		SkipSpaces();
-		if (*current != '{' && *current != '[')
+		if (!elementList && (current == end || (*current != '{' && *current != '[')))
 		{
 			Token token;
 			token.type = TokenType::tokenError;
@@ -32,76 +82,185 @@ namespace Json
 			token.end = end;
 			return SetError("A valid JSON document must be either an array or an object value.", token);
 		}
+		return true;
+	}
+
+	bool JsonReader::ParseArrayInParallel(const char* beginText, const char* endText, JsonObject& root)
+	{
+		// Consecutive elements of the root array.
+		struct Piece
+		{
+			const char* begin;
+			const char* end;
+			JsonObject elements;
+			bool succeed = false;
+			ErrorInfo errorInfo;
+		};
+
+		// Pieces are appended while being parsed, deque keeps references to them valid.
+		std::deque<Piece> pieces;
+		std::mutex mutex;
+		std::condition_variable pieceAdded;
+		size_t claimed = 0;
+		bool splitDone = false;
+		bool failed = false;
+
+		auto parsePieces = [&]()
+		{
+			JsonReader reader;
+			reader.mode = mode;
+			reader.inSitu = inSitu;
+			reader.lazyNumbers = lazyNumbers;
+			reader.packedArrays = packedArrays;
+			// Elements are parsed inside a list frame standing for the root array, so the depth is the same.
+			reader.maxDepth = maxDepth;
+
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true)
+			{
+				pieceAdded.wait(lock, [&] { return claimed < pieces.size() || splitDone; });
+				if (claimed == pieces.size() || failed)
+					return;
+
+				Piece& piece = pieces[claimed++];
+				lock.unlock();
+				piece.succeed = reader.ParseElements(piece.begin, piece.end, piece.elements);
+				if (!piece.succeed)
+					piece.errorInfo = reader.errorInfo;
+				lock.lock();
+				failed = failed || !piece.succeed;
+			}
+		};
+
+		unsigned int workerCount = threadCount != 0 ? threadCount : std::thread::hardware_concurrency();
+		if (workerCount == 0)
+			workerCount = 1;
+		// Calling thread joins the workers after splitting.
+		vector<std::thread> workers;
+		workers.reserve(workerCount - 1);
+		for (unsigned int i = 1; i < workerCount; ++i)
+			workers.emplace_back(parsePieces);
+
+		// Several pieces per thread even out their different parse costs.
+		size_t pieceSize = static_cast<size_t>(endText - beginText) / (size_t(workerCount) * 4);
+		pieceSize = pieceSize < minPieceSize ? minPieceSize : (pieceSize > maxPieceSize ? maxPieceSize : pieceSize);
+		bool isArray = indexer.SplitArray(beginText, endText, pieceSize, [&](size_t pieceBegin, size_t pieceEnd)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			pieces.emplace_back();
+			pieces.back().begin = beginText + pieceBegin;
+			pieces.back().end = beginText + pieceEnd;
+			pieceAdded.notify_one();
+		});
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			splitDone = true;
+			failed = failed || !isArray;
+			pieceAdded.notify_all();
+		}
+		parsePieces();
+		for (std::thread& worker : workers)
+			worker.join();
+
+		if (!isArray)
+		{
+			domHandler.Reset(root, inSitu);
+			if (Parse(beginText, endText, domHandler))
+				return true;
+			domHandler.Discard();
+			return false;
+		}
+
+		// Error location is resolved against the whole text.
+		current = begin = beginText;
+		end = endText;
+		size_t elementCount = 0;
+		for (Piece& piece : pieces)
+		{
+			if (!piece.succeed)
+			{
+				errorInfo = piece.errorInfo;
+				root = JsonObject();
+				return false;
+			}
+			elementCount += piece.elements.Size();
+		}
+
+		// Stitch pieces together, elements are moved, not copied.
+		root = std::move(pieces.front().elements);
+		root.Reserve(static_cast<unsigned int>(elementCount));
+		for (size_t i = 1; i < pieces.size(); ++i)
+		{
+			for (auto it = pieces[i].elements.ArrayBegin(); it != pieces[i].elements.ArrayEnd(); ++it)
+				root.Append(std::move(*it));
+		}
+		return true;
+	}
 
-		bool succeed = ReadValue(root);
+	bool JsonReader::ParseElements(const char* beginText, const char* endText, JsonObject& elements)
+	{
+		domHandler.Reset(elements, inSitu);
+		elementList = true;
+		bool succeed = Parse(beginText, endText, domHandler);
+		elementList = false;
 		return succeed;
 	}
 
+	bool JsonReader::ParseFile(const string& path, JsonObject& root)
+	{
+		JsonMappedFile file;
+		if (!file.Open(path.c_str()))
+		{
+			Token token;
+			token.type = TokenType::tokenError;
+			current = begin = end = token.start = token.end = nullptr;
+			SetError(file.GetErrorMessage().c_str(), token);
+			errorInfo.hasLocation = true;
+			errorInfo.line = errorInfo.column = 0;
+			return false;
+		}
+
+		if (Parse(file.Begin(), file.End(), root))
+			return true;
+
+		// Mapping is released on return, so resolve error location while text is available.
+		GetLocationLineAndColumn(errorInfo.token.start, errorInfo.line, errorInfo.column);
+		errorInfo.hasLocation = true;
+		return false;
+	}
+
 	string JsonReader::GetErrorMessage() const
 	{
 		if (errorInfo.message.empty())
 			return "";
 
-		int line, column;
-		GetLocationLineAndColumn(errorInfo.token.start, line, column);
+		int line = errorInfo.line, column = errorInfo.column;
+		if (!errorInfo.hasLocation)
+			GetLocationLineAndColumn(errorInfo.token.start, line, column);
 		string message = "Error in Line " + std::to_string(line) + ':'
 			+ std::to_string(column) + ": " + errorInfo.message + '\n';
 
 		return message;
 	}
 
-	bool JsonReader::ReadValue(JsonObject& object)
-	{
-		Token token;
-		if (!ReadToken(token))
-			return SetError("Syntax error: value, object or array expected.", token);
-
-		return ReadValue(token, object);
-	}
-
-	bool JsonReader::ReadValue(Token& token, JsonObject& object)
+	void JsonReader::Reset()
 	{
-		bool succeed = true;
-		switch (token.type)
-		{
-		case TokenType::tokenObjectBegin:
-			succeed = ReadObject(object);
-			break;
-		case TokenType::tokenArrayBegin:
-			succeed = ReadArray(object);
-			break;
-		case TokenType::tokenString:
-			succeed = DecodeString(token, object);
-			break;
-		case TokenType::tokenInteger:
-		case TokenType::tokenReal:
-			succeed = DecodeNumber(token, object);
-			break;
-		case TokenType::tokenTrue:
-			object = true;
-			break;
-		case TokenType::tokenFalse:
-			object = false;
-			break;
-		case TokenType::tokenNull:
-			object = JsonObject();
-			break;
-			// Unexpected Tokens.
-		case TokenType::tokenComma:
-		case TokenType::tokenColon:
-		case TokenType::tokenObjectEnd:
-		case TokenType::tokenArrayEnd:
-		case TokenType::tokenError:
-		default:
-			return SetError("Syntax error: Unexpected token.", token);
-		}
-
-		return succeed;
+		begin = current = end = nullptr;
+		bytesSkipped = 0;
+		structuralIndex.clear();
+		structuralPosition = 0;
+		containerStack.clear();
+		domHandler.Reset();
+		errorInfo.message.clear();
+		errorInfo.hasLocation = false;
 	}
 
 	bool JsonReader::ReadToken(Token& token)
 	{
-		SkipSpaces();
+		if (mode == ReaderMode::Structural)
+			SkipToNextStructural();
+		else
+			SkipSpaces();
 		token.start = current;
 		char c = GetNextChar();
 
@@ -165,6 +324,10 @@ namespace Json
 			succeed = false;
 			break;
 		}
+		// Index points only to the first byte of number/literal, so check it is not followed by garbage.
+		if (succeed && mode == ReaderMode::Structural && token.type >= TokenType::tokenInteger &&
+			token.type <= TokenType::tokenNull && current != end && !IsDelimiter(*current))
+			succeed = false;
 		// If not succeed, then token type is error.
 		if (!succeed)
 			token.type = TokenType::tokenError;
@@ -173,82 +336,27 @@ namespace Json
 		return succeed;
 	}
 
-	bool JsonReader::ReadObject(JsonObject& object)
+	bool JsonReader::ReadString()
 	{
-		Token nameToken, colon, comma;
-		string name;
-		while (ReadToken(nameToken))
+		// Closing quote is the next entry of structural index.
+		if (mode == ReaderMode::Structural)
 		{
-			// If empty object.
-			if (nameToken.type == TokenType::tokenObjectEnd)
-				return true;
-			// Clear name.
-			name.clear();
-			// Check and Decode name.
-			if (nameToken.type != TokenType::tokenString || !DecodeString(nameToken, name))
+			if (structuralPosition == structuralIndex.size())
 			{
-				if (nameToken.type != TokenType::tokenString)
-					return SetError("Expected object member name.", nameToken);
-				else // Error already set.
-					return false;
+				current = end;
+				return false;
 			}
-			// Read and Check colon.
-			if (!ReadToken(colon) || colon.type != TokenType::tokenColon)
-				return SetError("Missing ':' after object member name.", colon);
-
-			// Read and Check value.
-			JsonObject value;
-			if (!ReadValue(value))
-				return false; // Error already set.
-
-			object[name] = std::move(value);
-			// Check for comma.
-			if (!ReadToken(comma) || (comma.type != TokenType::tokenComma && comma.type != TokenType::tokenObjectEnd))
-				return SetError("Missing ',' or '}' after object member value.", colon);
-
-			// If object ended.
-			if (comma.type == TokenType::tokenObjectEnd)
-				return true;
+			current = begin + structuralIndex[structuralPosition++] + 1;
+			return true;
 		}
 
-		return false;
-	}
-
-	bool JsonReader::ReadArray(JsonObject& object)
-	{
-		Token valueToken, comma;
-		while (true)
-		{
-			if (!ReadToken(valueToken))
-				return false; // Error already set.
-
-			// If empty array.
-			if (valueToken.type == TokenType::tokenArrayEnd)
-				return true;
-
-			// Read and Check value.
-			JsonObject value;
-			if (!ReadValue(valueToken, value))
-				return false; // Error already set.
-
-			object.Append(std::move(value));
-			// Check for comma.
-			if (!ReadToken(comma) || (comma.type != TokenType::tokenComma && comma.type != TokenType::tokenArrayEnd))
-				return SetError("Missing ',' or ']' after array value.", comma);
-
-			// If array ended.
-			if (comma.type == TokenType::tokenArrayEnd)
-				return true;
-		}
-	}
-
-	bool JsonReader::ReadString()
-	{
 		char c;
 		while (current != end)
 		{
 			c = GetNextChar();
-			if (c == '"')
+			if (c == '\\') // Skip escaped character.
+				GetNextChar();
+			else if (c == '"')
 				return true;
 		}
 		return false;
@@ -256,117 +364,140 @@ namespace Json
 
 	bool JsonReader::ReadNumber(TokenType& outType)
 	{
-		char c = *current;
+		// Only find the end of number here, grammar is checked by 'JsonNumberParser'.
 		outType = TokenType::tokenInteger;
-		// Integral part.
-		while (c >= '0' && c <= '9')
+		while (current != end)
 		{
-			if (current == end)
-				return false;
+			char c = *current;
+			if (c == '.' || c == 'e' || c == 'E')
+				outType = TokenType::tokenReal;
+			else if ((c < '0' || c > '9') && c != '-' && c != '+')
+				break;
 			++current;
-			c = *current;
 		}
-		// Fractional part.
-		if (c == '.')
+
+		return true;
+	}
+
+	bool JsonReader::ReadMemberName(const Token& nameToken, string_view& name)
+	{
+		// Check and Decode name.
+		if (nameToken.type != TokenType::tokenString)
+			return SetError("Expected object member name.", nameToken);
+		if (!DecodeString(nameToken, name))
+			return false; // Error already set.
+
+		// Read and Check colon.
+		Token colon;
+		if (!ReadToken(colon) || colon.type != TokenType::tokenColon)
+			return SetError("Missing ':' after object member name.", colon);
+		return true;
+	}
+
+	bool JsonReader::SkipValue(const Token& token)
+	{
+		switch (token.type)
+		{
+		case TokenType::tokenString:
+		case TokenType::tokenInteger:
+		case TokenType::tokenReal:
+		case TokenType::tokenTrue:
+		case TokenType::tokenFalse:
+		case TokenType::tokenNull:
+			return true; // Already passed by 'ReadToken'.
+		case TokenType::tokenObjectBegin:
+		case TokenType::tokenArrayBegin:
+			break;
+		default:
+			return SetError("Syntax error: Unexpected token.", token);
+		}
+
+		// Match brackets, contents are not validated.
+		size_t depth = 1;
+		if (mode == ReaderMode::Structural)
 		{
-			++current;
-			c = *current;
-			outType = TokenType::tokenReal;
-			while (c >= '0' && c <= '9')
+			// Index has no brackets inside strings.
+			while (structuralPosition != structuralIndex.size())
 			{
-				if (current == end)
-					return false;
-				++current;
-				c = *current;
+				char c = begin[structuralIndex[structuralPosition++]];
+				if (c == '{' || c == '[')
+					++depth;
+				else if ((c == '}' || c == ']') && --depth == 0)
+				{
+					current = begin + structuralIndex[structuralPosition - 1] + 1;
+					return true;
+				}
 			}
 		}
-		// Exponential part.
-		if (c == 'e' || c == 'E')
+		else
 		{
-			++current;
-			c = *current;
-			if (c == '+' || c == '-')
+			while (current != end)
 			{
-				++current;
-				c = *current;
-				outType = TokenType::tokenReal;
-				while (c >= '0' && c <= '9')
+				char c = *current++;
+				if (c == '"')
 				{
-					if (current == end)
-						return false;
-					++current;
-					c = *current;
+					// Skip string, with escaped characters.
+					while (current != end && *current != '"')
+						current += (*current == '\\' && current + 1 != end) ? 2 : 1;
+					if (current != end)
+						++current;
 				}
+				else if (c == '{' || c == '[')
+					++depth;
+				else if ((c == '}' || c == ']') && --depth == 0)
+					return true;
 			}
-			else
-				return false;
 		}
 
-		return true;
-	}
-
-	bool JsonReader::DecodeString(const Token& token, JsonObject& object)
-	{
-		string decoded;
-		if (!DecodeString(token, decoded))
-			return false;
-
-		object = decoded;
-		return true;
+		current = end;
+		return SetError("Unexpected end of JSON text.", token);
 	}
 
-	bool JsonReader::DecodeString(const Token& token, string& decodedText)
+	bool JsonReader::DecodeString(const Token& token, string_view& decodedText)
 	{
-		if (*(token.end - 1) != '"')
+		if (token.end - token.start < 2 || *(token.end - 1) != '"')
 			return SetError("Unexpected end of string.", token);
 
-		int length = token.end - token.start - 2; // Skip '"'s
-		decodedText.reserve(length);
-		const char* current = token.start + 1; // Skip '"'
-		const char* end = token.end - 1;
-		while (current != end)
+		if (inSitu)
 		{
-			// TODO: Handle Escape Sequences.
-			char c = *current++;
-			decodedText += c;
+			// Cast is safe, text was given as mutable to 'ParseInSitu'.
+			char* start = const_cast<char*>(token.start) + 1; // Skip '"'
+			char* decodedEnd;
+			if (!JsonStringDecoder::DecodeInSitu(start, const_cast<char*>(token.end) - 1, decodedEnd))
+				return SetError("Invalid escape sequence or character in string.", token);
+
+			decodedText = string_view(start, decodedEnd - start);
+			return true;
 		}
+
+		decodeBuffer.clear();
+		if (!JsonStringDecoder::Decode(token.start + 1, token.end - 1, decodeBuffer))
+			return SetError("Invalid escape sequence or character in string.", token);
+
+		decodedText = decodeBuffer;
 		return true;
 	}
 
-	bool JsonReader::DecodeNumber(const Token& token, JsonObject& object)
+	bool JsonReader::DecodeNumber(const Token& token, JsonNumberParser::Number& number)
 	{
-		string buffer(token.start, token.end);
-		std::istringstream is(buffer);
-		if (token.type == TokenType::tokenInteger)
-		{
-			bool isNegative = is.peek() == '-';
-			int value;
-			if (is >> value)
-			{
-				object = isNegative ? value : static_cast<unsigned int>(value);
-				return true;
-			}
-		}
-		else if (token.type == TokenType::tokenReal)
-		{
-			float value;
-			if (is >> value)
-			{
-				object = value;
-				return true;
-			}
-		}
-
-		return false;
+		if (!JsonNumberParser::Parse(token.start, token.end, number))
+			return SetError("Invalid number.", token);
+		return true;
 	}
 
 	bool JsonReader::SetError(const char* message, const Token& token)
 	{
 		errorInfo.token = token;
 		errorInfo.message = message;
+		errorInfo.hasLocation = false;
 		return false;
 	}
 
+	bool JsonReader::SetStopped(const Token& token)
+	{
+		return SetError("Parsing stopped by handler.", token);
+	}
+
 	void JsonReader::GetLocationLineAndColumn(const char* location, int& line, int& column) const
 	{
 		const char* current = begin;
@@ -398,6 +529,35 @@ namespace Json
 		}
 	}
 
+	void JsonReader::SkipToNextStructural()
+	{
+		if (structuralPosition == structuralIndex.size())
+			current = end;
+		else
+			current = begin + structuralIndex[structuralPosition++];
+	}
+
+	bool JsonReader::IsDelimiter(char c) const
+	{
+		switch (c)
+		{
+		case ' ':
+		case '\n':
+		case '\t':
+		case '\r':
+		case ',':
+		case ':':
+		case '{':
+		case '}':
+		case '[':
+		case ']':
+		case '"':
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	char JsonReader::GetNextChar()
 	{
 		if (current == end)
@@ -0,0 +1,82 @@
+#include "JsonString.h"
+#include "Assertions.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace Json
+{
+	JsonString::JsonString(const char* value, size_t length)
+		: length(static_cast<uint32_t>(length)), owned(true)
+	{
+		char* copy = static_cast<char*>(malloc(length + 1));
+		ASSERT_TRUE((copy != nullptr), "Failed to allocate string buffer");
+
+		memcpy(copy, value, length);
+		copy[length] = '\0';
+		data = copy;
+	}
+
+	JsonString::JsonString(const string& value)
+		: JsonString(value.data(), value.length())
+	{
+	}
+
+	JsonString::JsonString(const JsonString& other)
+		: JsonString(other.data, other.length)
+	{
+	}
+
+	JsonString::JsonString(JsonString&& other) noexcept
+		: data(other.data), length(other.length), owned(other.owned)
+	{
+		// Reset.
+		other.data = "";
+		other.length = 0;
+		other.owned = false;
+	}
+
+	JsonString::~JsonString()
+	{
+		CleanUp();
+	}
+
+	JsonString JsonString::Borrow(const char* value, size_t length)
+	{
+		JsonString str;
+		str.data = value;
+		str.length = static_cast<uint32_t>(length);
+		return str;
+	}
+
+	JsonString& JsonString::operator=(const JsonString& other)
+	{
+		if (this != &other)
+			*this = JsonString(other);
+		return *this;
+	}
+
+	JsonString& JsonString::operator=(JsonString&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		// Cleanup.
+		CleanUp();
+		// Member-wise move.
+		data = other.data;
+		length = other.length;
+		owned = other.owned;
+		// Reset.
+		other.data = "";
+		other.length = 0;
+		other.owned = false;
+
+		return *this;
+	}
+
+	void JsonString::CleanUp()
+	{
+		if (owned)
+			free(const_cast<char*>(data));
+	}
+}
@@ -0,0 +1,264 @@
+#include "JsonStringDecoder.h"
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JSON_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace Json
+{
+	namespace
+	{
+		// Returns decoded character of single character escape sequence, or '\0' if invalid.
+		inline char DecodeEscape(char c)
+		{
+			switch (c)
+			{
+			case '"': return '"';
+			case '\\': return '\\';
+			case '/': return '/';
+			case 'b': return '\b';
+			case 'f': return '\f';
+			case 'n': return '\n';
+			case 'r': return '\r';
+			case 't': return '\t';
+			default: return '\0';
+			}
+		}
+
+		/** Returns first backslash, control character or non-ASCII byte in [current, end), or 'end'. */
+		inline const char* FindSpecial(const char* current, const char* end)
+		{
+#ifdef JSON_SSE2
+			const __m128i backslash = _mm_set1_epi8('\\');
+			// Signed compare, so bytes 0x80-0xFF are below it too.
+			const __m128i controlLimit = _mm_set1_epi8(0x20);
+			while (end - current >= 16)
+			{
+				__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current));
+				__m128i special = _mm_or_si128(_mm_cmpeq_epi8(block, backslash), _mm_cmplt_epi8(block, controlLimit));
+				unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(special));
+				if (mask != 0)
+				{
+#ifdef _MSC_VER
+					unsigned long index;
+					_BitScanForward(&index, mask);
+					return current + index;
+#else
+					return current + __builtin_ctz(mask);
+#endif
+				}
+				current += 16;
+			}
+#endif
+			while (current != end)
+			{
+				uint8_t c = static_cast<uint8_t>(*current);
+				if (c < 0x20 || c >= 0x80 || c == '\\')
+					break;
+				++current;
+			}
+			return current;
+		}
+
+		/** Returns length of valid UTF-8 sequence starting at 'current' with a non-ASCII byte, or 0. */
+		inline int ValidateUtf8Sequence(const char* current, const char* end)
+		{
+			const uint8_t* bytes = reinterpret_cast<const uint8_t*>(current);
+			size_t available = end - current;
+			uint8_t lead = bytes[0];
+			int length;
+			// Allowed range of the second byte excludes overlong forms and surrogates.
+			uint8_t secondMin = 0x80, secondMax = 0xBF;
+			if (lead >= 0xC2 && lead <= 0xDF)
+				length = 2;
+			else if (lead >= 0xE0 && lead <= 0xEF)
+			{
+				length = 3;
+				if (lead == 0xE0)
+					secondMin = 0xA0;
+				else if (lead == 0xED)
+					secondMax = 0x9F;
+			}
+			else if (lead >= 0xF0 && lead <= 0xF4)
+			{
+				length = 4;
+				if (lead == 0xF0)
+					secondMin = 0x90;
+				else if (lead == 0xF4)
+					secondMax = 0x8F;
+			}
+			else
+				return 0;
+
+			if (available < static_cast<size_t>(length) || bytes[1] < secondMin || bytes[1] > secondMax)
+				return 0;
+			for (int i = 2; i < length; ++i)
+			{
+				if ((bytes[i] & 0xC0) != 0x80)
+					return 0;
+			}
+			return length;
+		}
+
+		/** Read 4 hex digits of unicode escape. */
+		inline bool ReadHex4(const char* current, const char* end, uint32_t& value)
+		{
+			if (end - current < 4)
+				return false;
+			value = 0;
+			for (int i = 0; i < 4; ++i)
+			{
+				char c = current[i];
+				uint32_t digit;
+				if (c >= '0' && c <= '9')
+					digit = c - '0';
+				else if (c >= 'a' && c <= 'f')
+					digit = c - 'a' + 10;
+				else if (c >= 'A' && c <= 'F')
+					digit = c - 'A' + 10;
+				else
+					return false;
+				value = (value << 4) | digit;
+			}
+			return true;
+		}
+
+		/** Write 'codePoint' as UTF-8 to 'out', returns number of bytes. */
+		inline int EncodeUtf8(uint32_t codePoint, char* out)
+		{
+			if (codePoint < 0x80)
+			{
+				out[0] = static_cast<char>(codePoint);
+				return 1;
+			}
+			if (codePoint < 0x800)
+			{
+				out[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+				out[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+				return 2;
+			}
+			if (codePoint < 0x10000)
+			{
+				out[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+				out[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+				out[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+				return 3;
+			}
+			out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+			out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+			out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+			out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+			return 4;
+		}
+
+		/** Decode unicode escape after "\u" at 'current', including a following low surrogate.
+		* 'current' is moved past it. Returns number of UTF-8 bytes written to 'out', or 0 if invalid. */
+		inline int DecodeUnicodeEscape(const char*& current, const char* end, char* out)
+		{
+			uint32_t codePoint;
+			if (!ReadHex4(current, end, codePoint))
+				return 0;
+			current += 4;
+
+			if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+				return 0; // Low surrogate without high one.
+			if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+			{
+				uint32_t low;
+				if (end - current < 6 || current[0] != '\\' || current[1] != 'u' ||
+					!ReadHex4(current + 2, end, low) || low < 0xDC00 || low > 0xDFFF)
+					return 0;
+				current += 6;
+				codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+			}
+			return EncodeUtf8(codePoint, out);
+		}
+
+		/** Validates and decodes [current, end) to 'out', which must provide 'Append(begin, end)'.
+		* Runs of plain ASCII are found a block at a time and appended at once. */
+		template<typename Output>
+		bool DecodeBody(const char* current, const char* end, Output& out)
+		{
+			while (current != end)
+			{
+				const char* special = FindSpecial(current, end);
+				out.Append(current, special);
+				current = special;
+				if (current == end)
+					break;
+
+				uint8_t c = static_cast<uint8_t>(*current);
+				if (c >= 0x80)
+				{
+					int length = ValidateUtf8Sequence(current, end);
+					if (length == 0)
+						return false;
+					out.Append(current, current + length);
+					current += length;
+				}
+				else if (c == '\\')
+				{
+					if (++current == end)
+						return false;
+					char escape = *current++;
+					char decoded[4];
+					int length;
+					if (escape == 'u')
+						length = DecodeUnicodeEscape(current, end, decoded);
+					else
+					{
+						decoded[0] = DecodeEscape(escape);
+						length = decoded[0] != '\0' ? 1 : 0;
+					}
+					if (length == 0)
+						return false;
+					out.Append(decoded, decoded + length);
+				}
+				else
+					return false; // Control characters must be escaped.
+			}
+			return true;
+		}
+
+		struct StringOutput
+		{
+			string& str;
+			inline void Append(const char* begin, const char* end) { str.append(begin, end); }
+		};
+
+		// Decoded text is never longer than source, so it overwrites only consumed bytes.
+		struct InSituOutput
+		{
+			char* current;
+			inline void Append(const char* begin, const char* end)
+			{
+				if (current != begin)
+					memmove(current, begin, end - begin);
+				current += end - begin;
+			}
+		};
+	}
+
+	bool JsonStringDecoder::Decode(const char* begin, const char* end, string& decoded)
+	{
+		decoded.reserve(decoded.length() + (end - begin));
+		StringOutput out{ decoded };
+		return DecodeBody(begin, end, out);
+	}
+
+	bool JsonStringDecoder::DecodeInSitu(char* begin, char* end, char*& decodedEnd)
+	{
+		InSituOutput out{ begin };
+		if (!DecodeBody(begin, end, out))
+			return false;
+
+		decodedEnd = out.current;
+		return true;
+	}
+}
@@ -0,0 +1,370 @@
+#include "JsonStructuralIndexer.h"
+#include <cstring>
+#include <limits.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define JSON_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define JSON_TARGET(isa) __attribute__((target(isa)))
+#else
+#define JSON_TARGET(isa)
+#endif
+
+namespace Json
+{
+	namespace
+	{
+		// Bit masks of one 64 byte block, bit 'i' describes byte 'i'.
+		struct BlockMasks
+		{
+			uint64_t quote;
+			uint64_t backslash;
+			uint64_t whitespace;
+			uint64_t op; // '{', '}', '[', ']', ':', ','
+		};
+
+		using ClassifyFunction = void (*)(const uint8_t* block, BlockMasks& masks);
+
+		constexpr size_t blockSize = 64;
+		// Bytes indexed at once when splitting an array.
+		constexpr size_t splitWindowSize = size_t(64) << 20;
+
+		inline int CountTrailingZeros(uint64_t value)
+		{
+#ifdef _MSC_VER
+			unsigned long index;
+			_BitScanForward64(&index, value);
+			return static_cast<int>(index);
+#else
+			return __builtin_ctzll(value);
+#endif
+		}
+
+		inline int CountOnes(uint64_t value)
+		{
+#ifdef _MSC_VER
+			return static_cast<int>(__popcnt64(value));
+#else
+			return __builtin_popcountll(value);
+#endif
+		}
+
+		// Returns mask with bits set from each quote up to (not including) the next one.
+		inline uint64_t PrefixXor(uint64_t value)
+		{
+			value ^= value << 1;
+			value ^= value << 2;
+			value ^= value << 4;
+			value ^= value << 8;
+			value ^= value << 16;
+			value ^= value << 32;
+			return value;
+		}
+
+		// Returns mask of characters escaped by backslash, carrying odd backslash runs between blocks.
+		inline uint64_t FindEscaped(uint64_t backslash, uint64_t& prevEscaped)
+		{
+			// First character is escaped by previous block, so it can't start a backslash sequence.
+			backslash &= ~prevEscaped;
+			uint64_t followsEscape = (backslash << 1) | prevEscaped;
+
+			// Sequences starting on odd bits are cleared with carry propagation.
+			const uint64_t evenBits = 0x5555555555555555ULL;
+			uint64_t oddSequenceStarts = backslash & ~evenBits & ~followsEscape;
+			uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+			prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0;
+			uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+
+			return (evenBits ^ invertMask) & followsEscape;
+		}
+
+		void ClassifyScalar(const uint8_t* block, BlockMasks& masks)
+		{
+			masks = BlockMasks{ 0, 0, 0, 0 };
+			for (size_t i = 0; i < blockSize; i++)
+			{
+				uint64_t bit = 1ULL << i;
+				switch (block[i])
+				{
+				case '"':
+					masks.quote |= bit;
+					break;
+				case '\\':
+					masks.backslash |= bit;
+					break;
+				case ' ':
+				case '\t':
+				case '\n':
+				case '\r':
+					masks.whitespace |= bit;
+					break;
+				case '{':
+				case '}':
+				case '[':
+				case ']':
+				case ':':
+				case ',':
+					masks.op |= bit;
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+#ifdef JSON_X86
+		JSON_TARGET("sse4.2")
+		void ClassifySSE42(const uint8_t* block, BlockMasks& masks)
+		{
+			const __m128i quote = _mm_set1_epi8('"');
+			const __m128i backslash = _mm_set1_epi8('\\');
+			const __m128i opSet = _mm_setr_epi8('{', '}', '[', ']', ':', ',', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+			const __m128i spaceSet = _mm_setr_epi8(' ', '\t', '\n', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+			const int mode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+
+			masks = BlockMasks{ 0, 0, 0, 0 };
+			for (int i = 0; i < 4; i++)
+			{
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+				int shift = i * 16;
+				masks.quote |= static_cast<uint64_t>(static_cast<uint16_t>(
+					_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, quote)))) << shift;
+				masks.backslash |= static_cast<uint64_t>(static_cast<uint16_t>(
+					_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, backslash)))) << shift;
+				masks.op |= static_cast<uint64_t>(static_cast<uint16_t>(
+					_mm_cvtsi128_si32(_mm_cmpestrm(opSet, 6, chunk, 16, mode)))) << shift;
+				masks.whitespace |= static_cast<uint64_t>(static_cast<uint16_t>(
+					_mm_cvtsi128_si32(_mm_cmpestrm(spaceSet, 4, chunk, 16, mode)))) << shift;
+			}
+		}
+
+		JSON_TARGET("avx2")
+		void ClassifyAVX2(const uint8_t* block, BlockMasks& masks)
+		{
+			masks = BlockMasks{ 0, 0, 0, 0 };
+			for (int i = 0; i < 2; i++)
+			{
+				__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i * 32));
+				int shift = i * 32;
+
+				__m256i quote = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+				__m256i backslash = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+				__m256i space = _mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\t'))),
+					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+				__m256i op = _mm256_or_si256(
+					_mm256_or_si256(
+						_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('}'))),
+						_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(']')))),
+					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(','))));
+
+				masks.quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(quote))) << shift;
+				masks.backslash |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(backslash))) << shift;
+				masks.whitespace |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(space))) << shift;
+				masks.op |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(op))) << shift;
+			}
+		}
+
+		bool CpuSupportsSSE42()
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 1);
+			return (info[2] & (1 << 20)) != 0;
+#else
+			return __builtin_cpu_supports("sse4.2");
+#endif
+		}
+
+		bool CpuSupportsAVX2()
+		{
+#ifdef _MSC_VER
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+			__cpuid(info, 1);
+			// AVX and OSXSAVE are required to use ymm registers.
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+				return false;
+			if ((_xgetbv(0) & 0x6) != 0x6)
+				return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2");
+#endif
+		}
+#endif // JSON_X86
+
+		ClassifyFunction GetClassifyFunction(SimdLevel level)
+		{
+			switch (level)
+			{
+#ifdef JSON_X86
+			case SimdLevel::AVX2:
+				return ClassifyAVX2;
+			case SimdLevel::SSE42:
+				return ClassifySSE42;
+#endif
+			case SimdLevel::Scalar:
+			default:
+				return ClassifyScalar;
+			}
+		}
+	}
+
+	SimdLevel JsonStructuralIndexer::DetectSimdLevel()
+	{
+#ifdef JSON_X86
+		static const SimdLevel detected = CpuSupportsAVX2() ? SimdLevel::AVX2 :
+			(CpuSupportsSSE42() ? SimdLevel::SSE42 : SimdLevel::Scalar);
+		return detected;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}
+
+	JsonStructuralIndexer::JsonStructuralIndexer()
+		: level(DetectSimdLevel())
+	{
+	}
+
+	JsonStructuralIndexer::JsonStructuralIndexer(SimdLevel level)
+		: level(level)
+	{
+		// Levels are ordered, so anything above detected one is unsupported.
+		SimdLevel supported = DetectSimdLevel();
+		if (static_cast<uint8_t>(level) > static_cast<uint8_t>(supported))
+			this->level = supported;
+	}
+
+	bool JsonStructuralIndexer::Index(const char* begin, const char* end, vector<uint32_t>& positions) const
+	{
+		positions.clear();
+		size_t length = end - begin;
+		if (length > UINT32_MAX)
+			return false;
+
+		ClassifyFunction classify = GetClassifyFunction(level);
+		const uint8_t* text = reinterpret_cast<const uint8_t*>(begin);
+
+		// Carried state between blocks.
+		uint64_t prevEscaped = 0;
+		uint64_t prevInString = 0;
+		uint64_t prevScalar = 0;
+
+		BlockMasks masks;
+		uint8_t tail[blockSize];
+		for (size_t offset = 0; offset < length; offset += blockSize)
+		{
+			// Last partial block is padded with spaces, so no bytes are read past the end.
+			const uint8_t* block = text + offset;
+			if (length - offset < blockSize)
+			{
+				memset(tail, ' ', blockSize);
+				memcpy(tail, block, length - offset);
+				block = tail;
+			}
+			classify(block, masks);
+
+			uint64_t escaped = FindEscaped(masks.backslash, prevEscaped);
+			uint64_t quote = masks.quote & ~escaped;
+			// Bits from opening quote up to (not including) closing quote.
+			uint64_t inString = PrefixXor(quote) ^ prevInString;
+			prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+			uint64_t op = masks.op & ~inString;
+			uint64_t scalar = ~(masks.op | masks.whitespace | quote | inString);
+			uint64_t scalarStart = scalar & ~((scalar << 1) | prevScalar);
+			prevScalar = scalar >> 63;
+
+			uint64_t structurals = op | quote | scalarStart;
+			size_t count = positions.size();
+			positions.resize(count + CountOnes(structurals));
+			uint32_t* out = positions.data() + count;
+			while (structurals != 0)
+			{
+				*out++ = static_cast<uint32_t>(offset + CountTrailingZeros(structurals));
+				structurals &= structurals - 1;
+			}
+		}
+		return true;
+	}
+
+	bool JsonStructuralIndexer::SplitArray(const char* begin, const char* end, size_t pieceSize,
+		const std::function<void(size_t pieceBegin, size_t pieceEnd)>& onPiece) const
+	{
+		size_t length = end - begin;
+		size_t offset = 0;
+		while (offset < length && (begin[offset] == ' ' || begin[offset] == '\n' || begin[offset] == '\t' || begin[offset] == '\r'))
+			++offset;
+		if (offset == length || begin[offset] != '[')
+			return false;
+
+		size_t pieceBegin = offset + 1;
+		size_t nextSplit = pieceBegin + pieceSize;
+		size_t depth = 1;
+		size_t windowBegin = pieceBegin;
+		size_t windowSize = splitWindowSize;
+		vector<uint32_t> positions;
+		while (windowBegin < length)
+		{
+			size_t windowEnd = length - windowBegin > windowSize ? windowBegin + windowSize : length;
+			if (!Index(begin + windowBegin, begin + windowEnd, positions))
+				return false;
+
+			// Next window starts after the last bracket/colon/comma, which is never inside a string.
+			size_t nextWindow = windowBegin;
+			for (uint32_t position : positions)
+			{
+				size_t at = windowBegin + position;
+				char c = begin[at];
+				if (c == '[' || c == '{')
+					depth++;
+				else if (c == ']' || c == '}')
+				{
+					if (--depth == 0)
+					{
+						onPiece(pieceBegin, at);
+						return true;
+					}
+				}
+				else if (c == ',')
+				{
+					if (depth == 1 && at >= nextSplit)
+					{
+						onPiece(pieceBegin, at);
+						pieceBegin = at + 1;
+						nextSplit = pieceBegin + pieceSize;
+					}
+				}
+				else if (c != ':')
+					continue; // Quote or number/literal.
+				nextWindow = at + 1;
+			}
+
+			if (windowEnd == length)
+				break;
+			if (nextWindow == windowBegin)
+			{
+				// Whole window is one string, retry with a larger one.
+				if (windowSize >= UINT32_MAX)
+					return false;
+				windowSize = windowSize * 2 < UINT32_MAX ? windowSize * 2 : UINT32_MAX;
+			}
+			else
+			{
+				windowBegin = nextWindow;
+				windowSize = splitWindowSize;
+			}
+		}
+		return false;
+	}
+}
@@ -0,0 +1,617 @@
+#include "JsonTapeDocument.h"
+#include "JsonDomHandler.h"
+#include "JsonReader.h"
+#include <cstring>
+
+namespace Json
+{
+	namespace
+	{
+		// Kind of tape entry, stored in its top byte, the rest is payload.
+		enum class TapeTag : uint8_t
+		{
+			Null,
+			True,
+			False,
+			// 32-bit numbers are stored in the payload.
+			Int,
+			UInt,
+			Float,
+			// 64-bit numbers are stored in the following entry.
+			Int64,
+			UInt64,
+			Double,
+			// Payload is offset of the string in the string buffer.
+			String,
+			// Payload is index of the end entry, with the member/element count above it.
+			ObjectBegin,
+			ArrayBegin,
+			// Payload is index of the begin entry.
+			ObjectEnd,
+			ArrayEnd
+		};
+
+		constexpr int tagShift = 56;
+		constexpr uint64_t payloadMask = (uint64_t(1) << tagShift) - 1;
+		constexpr int countShift = 32;
+		constexpr uint64_t endIndexMask = (uint64_t(1) << countShift) - 1;
+		// Larger counts are stored as this and found by walking the container.
+		constexpr uint64_t maxStoredCount = (uint64_t(1) << (tagShift - countShift)) - 1;
+
+		inline uint64_t MakeEntry(TapeTag tag, uint64_t payload)
+		{
+			return (static_cast<uint64_t>(tag) << tagShift) | payload;
+		}
+
+		inline TapeTag GetTag(uint64_t entry) { return static_cast<TapeTag>(entry >> tagShift); }
+		inline uint64_t GetPayload(uint64_t entry) { return entry & payloadMask; }
+
+		/** Returns index of the entry following value at 'index'. */
+		inline size_t NextIndex(const vector<uint64_t>& tape, size_t index)
+		{
+			switch (GetTag(tape[index]))
+			{
+			case TapeTag::ObjectBegin:
+			case TapeTag::ArrayBegin:
+				return (GetPayload(tape[index]) & endIndexMask) + 1;
+			case TapeTag::Int64:
+			case TapeTag::UInt64:
+			case TapeTag::Double:
+				return index + 2;
+			default:
+				return index + 1;
+			}
+		}
+
+		inline string_view ReadString(const string& strings, uint64_t offset)
+		{
+			uint32_t length;
+			memcpy(&length, strings.data() + offset, sizeof(length));
+			return string_view(strings.data() + offset + sizeof(length), length);
+		}
+
+		/** Report values of tape entries [index, endIndex) to 'handler' as reader events. */
+		template<typename Handler>
+		bool Replay(const vector<uint64_t>& tape, const string& strings, size_t index, size_t endIndex, Handler& handler)
+		{
+			// Open object/array and number of values read into it.
+			struct Frame
+			{
+				bool isObject;
+				size_t count;
+			};
+			vector<Frame> stack;
+			// Strings are member names where an object expects one.
+			bool expectName = false;
+
+			while (index != endIndex)
+			{
+				uint64_t entry = tape[index];
+				uint64_t payload = GetPayload(entry);
+				bool succeed;
+				switch (GetTag(entry))
+				{
+				case TapeTag::Null: succeed = handler.Null(); break;
+				case TapeTag::True: succeed = handler.Bool(true); break;
+				case TapeTag::False: succeed = handler.Bool(false); break;
+				case TapeTag::Int: succeed = handler.Int(static_cast<int>(static_cast<uint32_t>(payload))); break;
+				case TapeTag::UInt: succeed = handler.UInt(static_cast<unsigned int>(payload)); break;
+				case TapeTag::Float:
+				{
+					// Reader events have no float, it is widened losslessly.
+					uint32_t bits = static_cast<uint32_t>(payload);
+					float value;
+					memcpy(&value, &bits, sizeof(value));
+					succeed = handler.Double(value);
+					break;
+				}
+				case TapeTag::Int64: succeed = handler.Int64(static_cast<int64_t>(tape[index + 1])); break;
+				case TapeTag::UInt64: succeed = handler.UInt64(tape[index + 1]); break;
+				case TapeTag::Double:
+				{
+					double value;
+					memcpy(&value, &tape[index + 1], sizeof(value));
+					succeed = handler.Double(value);
+					break;
+				}
+				case TapeTag::String:
+					if (expectName)
+					{
+						if (!handler.Key(ReadString(strings, payload)))
+							return false;
+						expectName = false;
+						++index;
+						continue;
+					}
+					succeed = handler.String(ReadString(strings, payload));
+					break;
+				case TapeTag::ObjectBegin:
+				case TapeTag::ArrayBegin:
+				{
+					bool isObject = GetTag(entry) == TapeTag::ObjectBegin;
+					if (!(isObject ? handler.StartObject() : handler.StartArray()))
+						return false;
+					stack.push_back(Frame{ isObject, 0 });
+					expectName = isObject;
+					++index;
+					continue;
+				}
+				default:
+					// Container end.
+					succeed = stack.back().isObject ? handler.EndObject(stack.back().count) : handler.EndArray(stack.back().count);
+					stack.pop_back();
+					break;
+				}
+				if (!succeed)
+					return false;
+
+				if (!stack.empty())
+				{
+					stack.back().count++;
+					expectName = stack.back().isObject;
+				}
+				index = NextIndex(tape, index);
+			}
+			return true;
+		}
+	}
+
+	class JsonTapeDocument::Builder
+	{
+	public:
+		explicit Builder(JsonTapeDocument& document)
+			: tape(document.tape), strings(document.strings) {}
+
+		bool Null()
+		{
+			tape.push_back(MakeEntry(TapeTag::Null, 0));
+			return true;
+		}
+
+		bool Bool(bool value)
+		{
+			tape.push_back(MakeEntry(value ? TapeTag::True : TapeTag::False, 0));
+			return true;
+		}
+
+		bool Int(int value)
+		{
+			tape.push_back(MakeEntry(TapeTag::Int, static_cast<uint32_t>(value)));
+			return true;
+		}
+
+		bool UInt(unsigned int value)
+		{
+			tape.push_back(MakeEntry(TapeTag::UInt, value));
+			return true;
+		}
+
+		bool Float(float value)
+		{
+			uint32_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			tape.push_back(MakeEntry(TapeTag::Float, bits));
+			return true;
+		}
+
+		bool Int64(int64_t value)
+		{
+			tape.push_back(MakeEntry(TapeTag::Int64, 0));
+			tape.push_back(static_cast<uint64_t>(value));
+			return true;
+		}
+
+		bool UInt64(uint64_t value)
+		{
+			tape.push_back(MakeEntry(TapeTag::UInt64, 0));
+			tape.push_back(value);
+			return true;
+		}
+
+		bool Double(double value)
+		{
+			uint64_t bits;
+			memcpy(&bits, &value, sizeof(bits));
+			tape.push_back(MakeEntry(TapeTag::Double, 0));
+			tape.push_back(bits);
+			return true;
+		}
+
+		bool String(string_view value)
+		{
+			uint32_t length = static_cast<uint32_t>(value.length());
+			tape.push_back(MakeEntry(TapeTag::String, strings.length()));
+			strings.append(reinterpret_cast<const char*>(&length), sizeof(length));
+			strings.append(value.data(), value.length());
+			strings.push_back('\0');
+			return true;
+		}
+
+		bool Key(string_view key) { return String(key); }
+		bool StartObject() { return StartContainer(TapeTag::ObjectBegin); }
+		bool EndObject(size_t memberCount) { return EndContainer(TapeTag::ObjectEnd, memberCount); }
+		bool StartArray() { return StartContainer(TapeTag::ArrayBegin); }
+		bool EndArray(size_t elementCount) { return EndContainer(TapeTag::ArrayEnd, elementCount); }
+
+		/** Returns true if building stopped because tape indices do not fit to entries. */
+		inline bool IsTooLarge() const { return tooLarge; }
+
+	private:
+		bool StartContainer(TapeTag tag)
+		{
+			openContainers.push_back(tape.size());
+			tape.push_back(MakeEntry(tag, 0));
+			return true;
+		}
+
+		bool EndContainer(TapeTag tag, size_t count)
+		{
+			size_t beginIndex = openContainers.back();
+			size_t endIndex = tape.size();
+			if (endIndex > endIndexMask)
+			{
+				tooLarge = true;
+				return false;
+			}
+			openContainers.pop_back();
+
+			uint64_t storedCount = count < maxStoredCount ? count : maxStoredCount;
+			tape[beginIndex] |= (storedCount << countShift) | endIndex;
+			tape.push_back(MakeEntry(tag, beginIndex));
+			return true;
+		}
+
+	private:
+		vector<uint64_t>& tape;
+		string& strings;
+		// Tape indices of begin entries of open objects/arrays.
+		vector<size_t> openContainers;
+		bool tooLarge = false;
+	};
+
+	JsonTapeValue JsonTapeValue::Iterator::operator*() const
+	{
+		return JsonTapeValue(document, members ? index + 1 : index);
+	}
+
+	string_view JsonTapeValue::Iterator::GetName() const
+	{
+		if (!members)
+			return string_view();
+		return ReadString(document->strings, GetPayload(document->tape[index]));
+	}
+
+	JsonTapeValue::Iterator& JsonTapeValue::Iterator::operator++()
+	{
+		index = NextIndex(document->tape, members ? index + 1 : index);
+		return *this;
+	}
+
+	JsonTapeValue JsonTapeValue::operator[](const char* key) const
+	{
+		return FindMember(key, strlen(key));
+	}
+
+	JsonTapeValue JsonTapeValue::operator[](const string& key) const
+	{
+		return FindMember(key.c_str(), key.length());
+	}
+
+	JsonTapeValue JsonTapeValue::operator[](int index) const
+	{
+		if (!IsArray() || index < 0)
+			return JsonTapeValue();
+
+		const vector<uint64_t>& tape = document->tape;
+		size_t endIndex = GetPayload(tape[this->index]) & endIndexMask;
+		size_t current = this->index + 1;
+		for (int i = 0; current != endIndex; ++i)
+		{
+			if (i == index)
+				return JsonTapeValue(document, current);
+			current = NextIndex(tape, current);
+		}
+		return JsonTapeValue();
+	}
+
+	JsonTapeValue::Iterator JsonTapeValue::ObjectBegin() const
+	{
+		if (!IsObject())
+			return Iterator(document, 0, true);
+		return Iterator(document, index + 1, true);
+	}
+
+	JsonTapeValue::Iterator JsonTapeValue::ObjectEnd() const
+	{
+		if (!IsObject())
+			return Iterator(document, 0, true);
+		return Iterator(document, GetPayload(document->tape[index]) & endIndexMask, true);
+	}
+
+	JsonTapeValue::Iterator JsonTapeValue::ArrayBegin() const
+	{
+		if (!IsArray())
+			return Iterator(document, 0, false);
+		return Iterator(document, index + 1, false);
+	}
+
+	JsonTapeValue::Iterator JsonTapeValue::ArrayEnd() const
+	{
+		if (!IsArray())
+			return Iterator(document, 0, false);
+		return Iterator(document, GetPayload(document->tape[index]) & endIndexMask, false);
+	}
+
+	bool JsonTapeValue::IsMember(const char* key) const
+	{
+		return FindMember(key, strlen(key)).IsValid();
+	}
+
+	bool JsonTapeValue::IsMember(const string& key) const
+	{
+		return FindMember(key.c_str(), key.length()).IsValid();
+	}
+
+	int JsonTapeValue::Size() const
+	{
+		if (!IsObject() && !IsArray())
+			return 0;
+
+		uint64_t count = GetPayload(document->tape[index]) >> countShift;
+		if (count < maxStoredCount)
+			return static_cast<int>(count);
+
+		int size = 0;
+		if (IsObject())
+		{
+			for (Iterator it = ObjectBegin(); it != ObjectEnd(); ++it)
+				++size;
+		}
+		else
+		{
+			for (Iterator it = ArrayBegin(); it != ArrayEnd(); ++it)
+				++size;
+		}
+		return size;
+	}
+
+	ValueType JsonTapeValue::GetType() const
+	{
+		if (document == nullptr)
+			return ValueType::Null;
+
+		switch (GetTag(document->tape[index]))
+		{
+		case TapeTag::True:
+		case TapeTag::False:
+			return ValueType::Bool;
+		case TapeTag::Int:
+			return ValueType::Int;
+		case TapeTag::UInt:
+			return ValueType::UInt;
+		case TapeTag::Float:
+			return ValueType::Float;
+		case TapeTag::Int64:
+			return ValueType::Int64;
+		case TapeTag::UInt64:
+			return ValueType::UInt64;
+		case TapeTag::Double:
+			return ValueType::Double;
+		case TapeTag::String:
+			return ValueType::String;
+		case TapeTag::ObjectBegin:
+			return ValueType::Object;
+		case TapeTag::ArrayBegin:
+			return ValueType::Array;
+		default:
+			return ValueType::Null;
+		}
+	}
+
+	bool JsonTapeValue::IsNumeric() const
+	{
+		ValueType type = GetType();
+		return type == ValueType::Int || type == ValueType::UInt || type == ValueType::Float ||
+			type == ValueType::Int64 || type == ValueType::UInt64 || type == ValueType::Double;
+	}
+
+	string_view JsonTapeValue::AsStringView() const
+	{
+		if (!IsString())
+			return string_view();
+		return ReadString(document->strings, GetPayload(document->tape[index]));
+	}
+
+	string JsonTapeValue::AsString() const { return ToScalar().AsString(); }
+	bool JsonTapeValue::AsBool() const { return ToScalar().AsBool(); }
+	int JsonTapeValue::AsInt() const { return ToScalar().AsInt(); }
+	unsigned int JsonTapeValue::AsUInt() const { return ToScalar().AsUInt(); }
+	float JsonTapeValue::AsFloat() const { return ToScalar().AsFloat(); }
+	int64_t JsonTapeValue::AsInt64() const { return ToScalar().AsInt64(); }
+	uint64_t JsonTapeValue::AsUInt64() const { return ToScalar().AsUInt64(); }
+	double JsonTapeValue::AsDouble() const { return ToScalar().AsDouble(); }
+
+	bool JsonTapeValue::AsString(string& value) const { return ToScalar().AsString(value); }
+	bool JsonTapeValue::AsBool(bool& value) const { return ToScalar().AsBool(value); }
+	bool JsonTapeValue::AsInt(int& value) const { return ToScalar().AsInt(value); }
+	bool JsonTapeValue::AsUInt(unsigned int& value) const { return ToScalar().AsUInt(value); }
+	bool JsonTapeValue::AsFloat(float& value) const { return ToScalar().AsFloat(value); }
+	bool JsonTapeValue::AsInt64(int64_t& value) const { return ToScalar().AsInt64(value); }
+	bool JsonTapeValue::AsUInt64(uint64_t& value) const { return ToScalar().AsUInt64(value); }
+	bool JsonTapeValue::AsDouble(double& value) const { return ToScalar().AsDouble(value); }
+
+	bool JsonTapeValue::ToObject(JsonObject& object) const
+	{
+		if (document == nullptr)
+			return false;
+
+		JsonDomHandler handler(object);
+		return Replay(document->tape, document->strings, index, NextIndex(document->tape, index), handler);
+	}
+
+	JsonTapeValue JsonTapeValue::FindMember(const char* key, size_t keyLength) const
+	{
+		if (!IsObject())
+			return JsonTapeValue();
+
+		string_view name(key, keyLength);
+		for (Iterator it = ObjectBegin(); it != ObjectEnd(); ++it)
+		{
+			if (it.GetName() == name)
+				return *it;
+		}
+		return JsonTapeValue();
+	}
+
+	JsonObject JsonTapeValue::ToScalar() const
+	{
+		if (document == nullptr)
+			return JsonObject();
+
+		const vector<uint64_t>& tape = document->tape;
+		uint64_t payload = GetPayload(tape[index]);
+		switch (GetTag(tape[index]))
+		{
+		case TapeTag::True:
+			return JsonObject(true);
+		case TapeTag::False:
+			return JsonObject(false);
+		case TapeTag::Int:
+			return JsonObject(static_cast<int>(static_cast<uint32_t>(payload)));
+		case TapeTag::UInt:
+			return JsonObject(static_cast<unsigned int>(payload));
+		case TapeTag::Float:
+		{
+			uint32_t bits = static_cast<uint32_t>(payload);
+			float value;
+			memcpy(&value, &bits, sizeof(value));
+			return JsonObject(value);
+		}
+		case TapeTag::Int64:
+			return JsonObject(static_cast<int64_t>(tape[index + 1]));
+		case TapeTag::UInt64:
+			return JsonObject(tape[index + 1]);
+		case TapeTag::Double:
+		{
+			double value;
+			memcpy(&value, &tape[index + 1], sizeof(value));
+			return JsonObject(value);
+		}
+		case TapeTag::String:
+		{
+			string_view value = ReadString(document->strings, payload);
+			return JsonObject::BorrowString(value.data(), static_cast<unsigned int>(value.length()));
+		}
+		default:
+			return JsonObject();
+		}
+	}
+
+	bool JsonTapeDocument::Parse(const char* beginText, const char* endText)
+	{
+		Clear();
+		Builder builder(*this);
+		JsonReader reader;
+		if (reader.Parse(beginText, endText, builder))
+			return true;
+
+		tape.clear();
+		strings.clear();
+		if (builder.IsTooLarge())
+			errorMessage = "JSON text is too large for tape document.";
+		else
+			errorMessage = reader.GetErrorMessage();
+		return false;
+	}
+
+	bool JsonTapeDocument::Parse(const string& json)
+	{
+		return Parse(json.c_str(), json.c_str() + json.length());
+	}
+
+	void JsonTapeDocument::FromObject(const JsonObject& object)
+	{
+		Clear();
+		Builder builder(*this);
+
+		// Open object/array with its next member/element.
+		struct Frame
+		{
+			const JsonObject* container;
+			JsonObject::ObjectConstIterator member;
+			JsonObject::ArrayConstIterator element;
+		};
+		vector<Frame> stack;
+		// Value to add next, nullptr after a container ends.
+		const JsonObject* value = &object;
+		// Copy of packed array element, the iterator it is read into moves on before it is added.
+		JsonObject packedElement;
+
+		while (true)
+		{
+			if (value != nullptr)
+			{
+				switch (value->GetType())
+				{
+				case ValueType::Null: builder.Null(); break;
+				case ValueType::String: builder.String(value->AsStringView()); break;
+				case ValueType::Bool: builder.Bool(value->AsBool()); break;
+				case ValueType::Int: builder.Int(value->AsInt()); break;
+				case ValueType::UInt: builder.UInt(value->AsUInt()); break;
+				case ValueType::Float: builder.Float(value->AsFloat()); break;
+				case ValueType::Int64: builder.Int64(value->AsInt64()); break;
+				case ValueType::UInt64: builder.UInt64(value->AsUInt64()); break;
+				case ValueType::Double: builder.Double(value->AsDouble()); break;
+				case ValueType::Object:
+					builder.StartObject();
+					stack.push_back(Frame{ value, value->ObjectConstBegin(), JsonObject::ArrayConstIterator() });
+					break;
+				case ValueType::Array:
+					builder.StartArray();
+					stack.push_back(Frame{ value, JsonObject::ObjectConstIterator(), value->ArrayConstBegin() });
+					break;
+				}
+			}
+			if (stack.empty())
+				break;
+
+			Frame& frame = stack.back();
+			if (frame.container->IsObject())
+			{
+				if (frame.member != frame.container->ObjectConstEnd())
+				{
+					builder.Key(frame.member->first.View());
+					value = &frame.member->second;
+					++frame.member;
+					continue;
+				}
+				builder.EndObject(frame.container->Size());
+			}
+			else
+			{
+				if (frame.element != frame.container->ArrayConstEnd())
+				{
+					if (frame.container->IsPackedArray())
+					{
+						packedElement = JsonObject(*frame.element);
+						value = &packedElement;
+					}
+					else
+						value = &*frame.element;
+					++frame.element;
+					continue;
+				}
+				builder.EndArray(frame.container->Size());
+			}
+			stack.pop_back();
+			value = nullptr;
+		}
+	}
+
+	void JsonTapeDocument::Clear()
+	{
+		tape.clear();
+		strings.clear();
+		errorMessage.clear();
+	}
+}
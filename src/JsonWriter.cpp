@@ -1,4 +1,5 @@
 #include "JsonWriter.h"
+#include <cmath>
 #include <sstream>
 
 namespace Json
@@ -34,9 +35,22 @@ namespace Json
 		case ValueType::Bool:
 		case ValueType::Int:
 		case ValueType::UInt:
-		case ValueType::Float:
+		case ValueType::Int64:
+		case ValueType::UInt64:
 			json += object.AsString();
 			break;
+		case ValueType::Float:
+		case ValueType::Double:
+			// Raw number is written as read, without converting it.
+			if (object.IsRawNumber())
+			{
+				char buffer[JsonObject::rawInlineCapacity];
+				json += object.RawToken(buffer);
+				break;
+			}
+			// JSON has no infinity or NaN, they are written as null.
+			json += std::isfinite(object.AsDouble()) ? object.AsString() : "null";
+			break;
 		case ValueType::String:
 			// If String, then add quotes.
 			json += ToQuoticString(object.AsString());
@@ -45,7 +59,10 @@ namespace Json
 			succeed = styled ? WriteStyledObject(json, object, deepLevel) : WriteObject(json, object);
 			break;
 		case ValueType::Array:
-			succeed = styled ? WriteStyledArray(json, object, deepLevel) : WriteArray(json, object);
+			if (object.IsPackedArray())
+				succeed = WritePackedArray(json, object);
+			else
+				succeed = styled ? WriteStyledArray(json, object, deepLevel) : WriteArray(json, object);
 			break;
 		default:
 			succeed = false;
@@ -59,6 +76,12 @@ namespace Json
 		bool succeed = true;
 		vector<string> names = object.GetMemberNames();
 		int size = names.size();
+		// Empty object/array has nothing to close in the loop below.
+		if (size == 0)
+		{
+			json += "{}";
+			return true;
+		}
 
 		json += '{';
 		for (int i = 0; i < size; i++)
@@ -77,6 +100,12 @@ namespace Json
 	{
 		bool succeed = true;
 		int size = object.Size();
+		// Empty object/array has nothing to close in the loop below.
+		if (size == 0)
+		{
+			json += "[]";
+			return true;
+		}
 
 		json += '[';
 		for (int i = 0; i < size; i++)
@@ -94,6 +123,12 @@ namespace Json
 		bool succeed = true, isMultiLine = IsMultiLine(object);
 		vector<string> names = object.GetMemberNames();
 		int size = names.size();
+		// Empty object/array has nothing to close in the loop below.
+		if (size == 0)
+		{
+			json += "{}";
+			return true;
+		}
 
 		if (deepLevel > 0 && isMultiLine)
 			json += '\n' + GetIndent(deepLevel);
@@ -119,6 +154,12 @@ namespace Json
 	{
 		bool succeed = true, isMultiLine = IsMultiLine(object);
 		int size = object.Size();
+		// Empty object/array has nothing to close in the loop below.
+		if (size == 0)
+		{
+			json += "[]";
+			return true;
+		}
 
 		if (deepLevel > 0 && isMultiLine)
 			json += '\n' + GetIndent(deepLevel);
@@ -138,18 +179,78 @@ namespace Json
 		return succeed;
 	}
 
+	bool JsonWriter::WritePackedArray(string& json, const JsonObject& object)
+	{
+		int size = object.Size();
+		// Empty object/array has nothing to close in the loop below.
+		if (size == 0)
+		{
+			json += "[]";
+			return true;
+		}
+
+		// Numbers are read from the packed buffer, not as element values.
+		JsonArrayView<int64_t> integers = object.AsInt64Array();
+		JsonArrayView<double> reals = object.AsDoubleArray();
+		json += styled ? "[ " : "[";
+		for (int i = 0; i < size; i++)
+		{
+			if (!integers.empty())
+				json += std::to_string(integers[i]);
+			else
+				json += std::isfinite(reals[i]) ? JsonObject(reals[i]).AsString() : "null";
+			if (i != size - 1)
+				json += styled ? ", " : ",";
+		}
+		json += styled ? " ]" : "]";
+		return true;
+	}
+
 	string JsonWriter::ToQuoticString(const string& str)
 	{
-		string newStr = '"' + str + '"';
+		string newStr;
+		newStr.reserve(str.length() + 2);
+		newStr += '"';
+		AppendEscaped(newStr, str);
+		newStr += '"';
 		return newStr;
 	}
 
 	string&& JsonWriter::ToQuoticString(string&& str)
 	{
-		str = '"' + str + '"';
+		str = ToQuoticString(static_cast<const string&>(str));
 		return std::move(str);
 	}
 
+	void JsonWriter::AppendEscaped(string& json, const string& str)
+	{
+		static const char hexDigits[] = "0123456789abcdef";
+		for (char c : str)
+		{
+			switch (c)
+			{
+			case '"': json += "\\\""; break;
+			case '\\': json += "\\\\"; break;
+			case '\b': json += "\\b"; break;
+			case '\f': json += "\\f"; break;
+			case '\n': json += "\\n"; break;
+			case '\r': json += "\\r"; break;
+			case '\t': json += "\\t"; break;
+			default:
+				// Other control characters must be written as unicode escapes.
+				if (static_cast<unsigned char>(c) < 0x20)
+				{
+					json += "\\u00";
+					json += hexDigits[(c >> 4) & 0xF];
+					json += hexDigits[c & 0xF];
+				}
+				else
+					json += c;
+				break;
+			}
+		}
+	}
+
 	string JsonWriter::GetIndent(int deepLevel)
 	{
 		string tabs;
@@ -174,7 +275,7 @@ namespace Json
 					return true;
 			}
 		}
-		else if (value.GetType() == ValueType::Array)
+		else if (value.GetType() == ValueType::Array && !value.IsPackedArray())
 		{
 			JsonObject::ArrayConstIterator begin = value.ArrayConstBegin();
 			JsonObject::ArrayConstIterator end = value.ArrayConstEnd();
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include "JsonReader.h"
+
+// GCC takes 'free' in the replaced operator delete for a mismatch with operator new.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+using namespace Json;
+
+namespace
+{
+	// Counts every allocation of the test binary, only differences are compared.
+	std::atomic<size_t> allocationCount{ 0 };
+}
+
+void* operator new(size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	if (void* pointer = std::malloc(size != 0 ? size : 1))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	size_t align = static_cast<size_t>(alignment);
+	if (void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align))
+		return pointer;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { std::free(pointer); }
+
+namespace
+{
+	void ExpectNoAllocationsAfterWarmUp(ReaderMode mode)
+	{
+		// Same shape, different values and string lengths within the first one's buffers.
+		const string messages[] =
+		{
+			R"({"id":12345,"name":"first message name","price":10.25,"tags":["alpha","beta","gamma"],"owner":{"id":7,"active":true}})",
+			R"({"id":6,"name":"second","price":3.5,"tags":["a","b","c"],"owner":{"id":700000,"active":false}})"
+		};
+
+		JsonReader reader;
+		reader.SetMode(mode);
+		Json::JsonObject root;
+		for (const string& message : messages)
+			ASSERT_TRUE(reader.Parse(message, root)) << reader.GetErrorMessage();
+
+		size_t before = allocationCount.load();
+		for (int i = 0; i < 1000; ++i)
+		{
+			if (!reader.Parse(messages[i % 2], root))
+				FAIL() << reader.GetErrorMessage();
+		}
+		EXPECT_EQ(allocationCount.load() - before, 0u);
+		EXPECT_EQ(root["tags"].Size(), 3);
+		EXPECT_EQ(root["owner"]["id"].AsInt(), 700000);
+	}
+}
+
+TEST(JsonAllocationTests, RepeatedScalarParsesDoNotAllocate)
+{
+	ExpectNoAllocationsAfterWarmUp(ReaderMode::Scalar);
+}
+
+TEST(JsonAllocationTests, RepeatedStructuralParsesDoNotAllocate)
+{
+	ExpectNoAllocationsAfterWarmUp(ReaderMode::Structural);
+}
@@ -0,0 +1,70 @@
+// Member lookup by 'JSON_KEY', 'const char*' and 'string_view' on a small
+// object (tag scan) and on a large one (hash index). Build with optimizations
+// and run without arguments, prints best time per lookup of 5 runs.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include "JsonObject.h"
+
+using namespace Json;
+
+namespace
+{
+	constexpr int lookupCount = 5000000;
+	constexpr int runCount = 5;
+
+	// Looked up name, 22 characters, added last so it is found after every other one is skipped.
+	constexpr const char* lookedUpName = "service.request.timing";
+
+	Json::JsonObject MakeObject(int memberCount)
+	{
+		Json::JsonObject object(ValueType::Object);
+		for (int i = 0; i < memberCount - 1; ++i)
+			object["member.name.number." + std::to_string(i)] = Json::JsonObject(i);
+		object[lookedUpName] = Json::JsonObject(memberCount);
+		return object;
+	}
+
+	/** Returns best nanoseconds per call of 'lookup', which returns the found value. */
+	template<typename Lookup>
+	double Measure(Lookup lookup)
+	{
+		double best = 1e300;
+		for (int run = 0; run < runCount; ++run)
+		{
+			int64_t sum = 0;
+			auto begin = std::chrono::steady_clock::now();
+			for (int i = 0; i < lookupCount; ++i)
+				sum += lookup().AsInt();
+			auto end = std::chrono::steady_clock::now();
+			// Sum is printed nowhere but keeps the loop from being removed.
+			volatile int64_t keep = sum;
+			(void)keep;
+			best = std::min(best, std::chrono::duration<double, std::nano>(end - begin).count() / lookupCount);
+		}
+		return best;
+	}
+
+	void Run(int memberCount)
+	{
+		const Json::JsonObject object = MakeObject(memberCount);
+		// Names are passed through volatile pointer, so the compiler can't hash them at compile time.
+		const char* volatile name = lookedUpName;
+
+		double keyTime = Measure([&]() -> const Json::JsonObject& { return object[JSON_KEY("service.request.timing")]; });
+		double charTime = Measure([&]() -> const Json::JsonObject& { return object[static_cast<const char*>(name)]; });
+		double viewTime = Measure([&]() -> const Json::JsonObject& { return object[string_view(name, 22)]; });
+		std::printf("%3d members: JSON_KEY %5.1f ns, const char* %5.1f ns, string_view %5.1f ns\n",
+			memberCount, keyTime, charTime, viewTime);
+	}
+}
+
+int main()
+{
+	// Small objects are scanned by tag, objects over 'indexThreshold' members use the index.
+	Run(9);
+	Run(65);
+	return 0;
+}
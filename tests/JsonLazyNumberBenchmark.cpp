@@ -0,0 +1,86 @@
+// Parsing a root array of objects with two reals each and a root array of reals,
+// with numbers converted while parsing and with lazy numbers, copying the text
+// and in situ. Build with optimizations and run without arguments, prints best
+// time of 9 runs.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "JsonReader.h"
+
+using namespace Json;
+
+namespace
+{
+	constexpr int objectCount = 1000000;
+	constexpr int runCount = 9;
+
+	string MakeObjects()
+	{
+		string json = "[";
+		char buffer[96];
+		for (int i = 0; i < objectCount; ++i)
+		{
+			// Reals of 4 to 11 characters.
+			std::snprintf(buffer, sizeof(buffer), "%s{\"id\":%d,\"x\":%.6f,\"y\":%.2f}",
+				i != 0 ? "," : "", i, i * 0.001, -i / 7.0);
+			json += buffer;
+		}
+		json += "]";
+		return json;
+	}
+
+	string MakeReals()
+	{
+		string json = "[";
+		char buffer[32];
+		for (int i = 0; i < 2 * objectCount; ++i)
+		{
+			std::snprintf(buffer, sizeof(buffer), "%s%.6f", i != 0 ? "," : "", i * 0.001);
+			json += buffer;
+		}
+		json += "]";
+		return json;
+	}
+
+	/** Returns milliseconds to parse 'json' into a new root. */
+	double ParseTime(const string& json, bool lazyNumbers, bool inSitu)
+	{
+		JsonReader reader;
+		// Single thread, so only the number representation differs.
+		reader.SetThreadCount(1);
+		reader.SetLazyNumbers(lazyNumbers);
+		string text = json;
+		Json::JsonObject root;
+		auto begin = std::chrono::steady_clock::now();
+		bool succeed = inSitu ? reader.ParseInSitu(&text[0], &text[0] + text.length(), root) : reader.Parse(text, root);
+		auto end = std::chrono::steady_clock::now();
+		if (!succeed)
+			std::printf("Parse failed: %s\n", reader.GetErrorMessage().c_str());
+		return std::chrono::duration<double, std::milli>(end - begin).count();
+	}
+
+	void Run(const char* name, const string& json, bool inSitu)
+	{
+		// Runs alternate, so both modes see the same machine load.
+		double eager = 1e300, lazy = 1e300;
+		for (int run = 0; run < runCount; ++run)
+		{
+			eager = std::min(eager, ParseTime(json, false, inSitu));
+			lazy = std::min(lazy, ParseTime(json, true, inSitu));
+		}
+		std::printf("%-7s %-7s eager %6.1f ms, lazy %6.1f ms\n", name, inSitu ? "in situ" : "copy", eager, lazy);
+	}
+}
+
+int main()
+{
+	const string objects = MakeObjects();
+	Run("objects", objects, false);
+	Run("objects", objects, true);
+	// Numbers only, so the difference is not hidden by building objects.
+	const string reals = MakeReals();
+	Run("reals", reals, false);
+	Run("reals", reals, true);
+	return 0;
+}
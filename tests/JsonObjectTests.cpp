@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include "JsonReader.h"
+
+using namespace Json;
+
+TEST(JsonObjectTests, CachedHashFollowsModifications)
+{
+	JsonReader reader;
+	Json::JsonObject root, same;
+	const string json = R"({"a":{"b":[1,2,{"c":"x"}]},"d":[1.5,2.5]})";
+	ASSERT_TRUE(reader.Parse(json, root));
+	ASSERT_TRUE(reader.Parse(json, same));
+
+	// Several threads hash the same values at once.
+	uint64_t hashes[4] = {};
+	std::thread threads[4];
+	const Json::JsonObject& values = root;
+	for (int t = 0; t < 4; ++t)
+		threads[t] = std::thread([&values, &hashes, t]() { hashes[t] = values.Hash(); });
+	for (std::thread& thread : threads)
+		thread.join();
+	for (uint64_t hash : hashes)
+		EXPECT_EQ(hash, same.Hash());
+
+	// Nested value modified after both are hashed.
+	root["a"]["b"][2]["c"] = Json::JsonObject("y");
+	EXPECT_NE(root.Hash(), same.Hash());
+	EXPECT_FALSE(root == same);
+	same["a"]["b"][2]["c"].SetString("y");
+	EXPECT_EQ(root.Hash(), same.Hash());
+	EXPECT_TRUE(root == same);
+
+	// Parsing into a hashed root drops its cache too.
+	uint64_t before = same.Hash();
+	ASSERT_TRUE(reader.Parse(string(R"({"a":{"b":[1,2,{"c":"z"}]},"d":[1.5,2.5]})"), same));
+	EXPECT_NE(same.Hash(), before);
+	EXPECT_FALSE(root == same);
+
+	// Values moved into the set keep their hashes, and are found by equal ones.
+	std::unordered_set<Json::JsonObject> set;
+	set.insert(Json::JsonObject(root));
+	set.insert(Json::JsonObject(same));
+	EXPECT_EQ(set.size(), 2u);
+	EXPECT_EQ(set.count(root), 1u);
+	root["d"].Append(Json::JsonObject(3.5));
+	EXPECT_EQ(set.count(root), 0u);
+}
+
+TEST(JsonObjectTests, CachedHashFollowsHeldReferences)
+{
+	JsonReader reader;
+	Json::JsonObject a, b;
+	ASSERT_TRUE(reader.Parse(string(R"({"a":{"b":1},"c":[1,2]})"), a));
+	ASSERT_TRUE(reader.Parse(string(R"({"a":{"b":2},"c":[1,2]})"), b));
+
+	// References taken before hashing, to a nested object and to a scalar in it.
+	Json::JsonObject& inner = a["a"];
+	Json::JsonObject& number = b["c"][1];
+	EXPECT_NE(a.Hash(), b.Hash());
+	inner["b"] = Json::JsonObject(2u);
+	EXPECT_TRUE(a == b);
+	EXPECT_EQ(a.Hash(), b.Hash());
+
+	std::unordered_set<Json::JsonObject> set;
+	set.insert(Json::JsonObject(a));
+	EXPECT_EQ(set.count(b), 1u);
+	number = Json::JsonObject(3);
+	EXPECT_FALSE(a == b);
+	EXPECT_NE(a.Hash(), b.Hash());
+	EXPECT_EQ(set.count(b), 0u);
+	number.SetString("x");
+	inner.SetMember(JsonString(string("d")), Json::JsonObject(true));
+	EXPECT_NE(a.Hash(), set.begin()->Hash());
+	EXPECT_EQ(set.count(*set.begin()), 1u);
+}
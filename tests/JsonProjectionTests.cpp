@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "JsonProjection.h"
+#include "JsonReader.h"
+
+using namespace Json;
+
+TEST(JsonProjectionTests, SelectedElementsKeepTheirIndex)
+{
+	JsonProjection projection;
+	ASSERT_TRUE(projection.AddPath("/items/1/price"));
+	ASSERT_TRUE(projection.AddPath("items[3]"));
+
+	JsonReader reader;
+	reader.SetProjection(&projection);
+	Json::JsonObject root;
+	ASSERT_TRUE(reader.Parse(string(R"({"items":[{"price":1},{"price":3,"name":"b"},7,"d",{"price":5}],"other":true})"), root));
+
+	const Json::JsonObject& items = root["items"];
+	ASSERT_EQ(items.Size(), 4);
+	EXPECT_TRUE(items[0].IsNull());
+	EXPECT_EQ(items[1]["price"].AsInt(), 3);
+	EXPECT_FALSE(items[1].IsMember("name"));
+	EXPECT_TRUE(items[2].IsNull());
+	EXPECT_EQ(items[3].AsString(), "d");
+	EXPECT_FALSE(root.IsMember("other"));
+}
+
+TEST(JsonProjectionTests, WildcardKeepsAllElements)
+{
+	JsonProjection projection;
+	ASSERT_TRUE(projection.AddPath("items[*].price"));
+
+	JsonReader reader;
+	reader.SetProjection(&projection);
+	Json::JsonObject root;
+	ASSERT_TRUE(reader.Parse(string(R"({"items":[{"price":1,"name":"a"},{"price":2}]})"), root));
+
+	ASSERT_EQ(root["items"].Size(), 2);
+	EXPECT_EQ(root["items"][0].Size(), 1);
+	EXPECT_EQ(root["items"][1]["price"].AsInt(), 2);
+}
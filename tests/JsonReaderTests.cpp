@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <thread>
+#include "JsonPushReader.h"
+#include "JsonQuery.h"
+#include "JsonReader.h"
+#include "JsonWriter.h"
+
+using namespace Json;
+
+TEST(JsonReaderTests, EmptyContainersAreNotNull)
+{
+	JsonReader reader;
+	Json::JsonObject root;
+	ASSERT_TRUE(reader.Parse(string(R"({"object":{},"array":[],"nested":[[],{}]})"), root));
+	EXPECT_TRUE(root["object"].IsObject());
+	EXPECT_TRUE(root["array"].IsArray());
+	EXPECT_TRUE(root["nested"][0].IsArray());
+	EXPECT_TRUE(root["nested"][1].IsObject());
+
+	ASSERT_TRUE(reader.Parse(string("{}"), root));
+	EXPECT_TRUE(root.IsObject());
+	ASSERT_TRUE(reader.Parse(string("[]"), root));
+	EXPECT_TRUE(root.IsArray());
+}
+
+TEST(JsonReaderTests, PushReaderMatchesReaderAtEverySplit)
+{
+	const string json = R"({"a":{},"b":[],"c":[1,"x\"y",{"d":[]}],"e":-1.5e3})";
+	JsonReader reader;
+	Json::JsonObject expected;
+	ASSERT_TRUE(reader.Parse(json, expected));
+
+	JsonPushReader pushReader;
+	for (size_t split = 0; split <= json.length(); ++split)
+	{
+		pushReader.Reset();
+		ASSERT_TRUE(pushReader.Feed(json.data(), split)) << "split at " << split;
+		ASSERT_TRUE(pushReader.Feed(json.data() + split, json.length() - split)) << "split at " << split;
+		ASSERT_TRUE(pushReader.Finish()) << "split at " << split;
+		EXPECT_TRUE(pushReader.GetRoot() == expected) << "split at " << split;
+	}
+}
+
+TEST(JsonReaderTests, ReusedRootTakesMemberOrderOfNewText)
+{
+	JsonReader reader;
+	JsonWriter writer;
+	Json::JsonObject root;
+	ASSERT_TRUE(reader.Parse(string(R"({"a":1,"b":2})"), root));
+	ASSERT_TRUE(reader.Parse(string(R"({"b":3,"a":4})"), root));
+	string json;
+	ASSERT_TRUE(writer.Write(json, root, false));
+	EXPECT_EQ(json, R"({"b":3,"a":4})");
+
+	// Large objects keep an index of positions, which must follow the moved members.
+	string forward = "{", backward = "{";
+	for (int i = 0; i < 40; ++i)
+	{
+		forward += (i != 0 ? ",\"m" : "\"m") + std::to_string(i) + "\":" + std::to_string(i);
+		backward += (i != 0 ? ",\"m" : "\"m") + std::to_string(39 - i) + "\":" + std::to_string(39 - i);
+	}
+	forward += ",\"extra\":true}";
+	backward += "}";
+
+	Json::JsonObject expected;
+	ASSERT_TRUE(reader.Parse(backward, expected));
+	ASSERT_TRUE(reader.Parse(forward, root));
+	ASSERT_TRUE(reader.Parse(backward, root));
+	EXPECT_EQ(root.GetMemberNames(), expected.GetMemberNames());
+	for (int i = 0; i < 40; ++i)
+		EXPECT_EQ(root["m" + std::to_string(i)].AsInt(), i);
+	EXPECT_FALSE(root.IsMember("extra"));
+}
+
+TEST(JsonReaderTests, LazyNumbersKeepTheirToken)
+{
+	JsonReader reader;
+	reader.SetLazyNumbers(true);
+	JsonWriter writer;
+	Json::JsonObject root;
+	ASSERT_TRUE(reader.Parse(string(R"([1.50,1e3,0.30000000000000004,-2.5])"), root));
+
+	// Values are read from several threads at once, the tokens must stay as read.
+	const Json::JsonObject& values = root;
+	double sums[4] = {};
+	std::thread threads[4];
+	for (int t = 0; t < 4; ++t)
+		threads[t] = std::thread([&values, &sums, t]()
+		{
+			for (int i = 0; i < 4; ++i)
+				sums[t] += values[i].AsDouble();
+		});
+	for (std::thread& thread : threads)
+		thread.join();
+	for (double sum : sums)
+		EXPECT_DOUBLE_EQ(sum, 1.5 + 1000.0 + 0.30000000000000004 - 2.5);
+
+	string json;
+	ASSERT_TRUE(writer.Write(json, root, false));
+	EXPECT_EQ(json, "[1.50,1e3,0.30000000000000004,-2.5]");
+	Json::JsonObject copy = root;
+	EXPECT_EQ(copy[0].AsDouble(), 1.5);
+	json.clear();
+	ASSERT_TRUE(writer.Write(json, copy, false));
+	EXPECT_EQ(json, "[1.50,1e3,0.30000000000000004,-2.5]");
+
+	// Parsing again into the same root replaces packed and heap tokens.
+	ASSERT_TRUE(reader.Parse(string(R"([2.25,7e-1,0.1,3.7500000000000000001])"), root));
+	EXPECT_EQ(root[0].AsDouble(), 2.25);
+	EXPECT_EQ(root[1].AsDouble(), 0.7);
+	json.clear();
+	ASSERT_TRUE(writer.Write(json, root, false));
+	EXPECT_EQ(json, "[2.25,7e-1,0.1,3.7500000000000000001]");
+
+	// Tokens out of double range are written as read, not converted to infinity.
+	ASSERT_TRUE(reader.Parse(string(R"([1e999,1.10,-2.50E+3,-1e999])"), root));
+	EXPECT_TRUE(std::isinf(root[0].AsDouble()));
+	json.clear();
+	ASSERT_TRUE(writer.Write(json, root, false));
+	EXPECT_EQ(json, "[1e999,1.10,-2.50E+3,-1e999]");
+
+	// Long tokens borrow the text when parsing in situ.
+	string text = "[0.1000000000000000055511151231257827,2.5]";
+	ASSERT_TRUE(reader.ParseInSitu(&text[0], &text[0] + text.length(), root));
+	EXPECT_EQ(root[0].AsDouble(), 0.1);
+	json.clear();
+	ASSERT_TRUE(writer.Write(json, root, false));
+	EXPECT_EQ(json, text);
+}
+
+TEST(JsonReaderTests, ConstAccessKeepsArraysPacked)
+{
+	JsonReader reader;
+	reader.SetPackedArrays(true);
+	Json::JsonObject root;
+	ASSERT_TRUE(reader.Parse(string(R"({"a":[1,-2,3,5000000000],"b":[0.5,1.5]})"), root));
+	const Json::JsonObject& values = root;
+
+	// Several threads read the same packed arrays at once.
+	int64_t sums[4] = {};
+	const Json::JsonObject* selected[4] = {};
+	std::thread threads[4];
+	JsonQuery query = JsonQuery::Compile("$.a[*]");
+	JsonQuery second = JsonQuery::Compile("$.b[1]");
+	ASSERT_TRUE(query.IsValid() && second.IsValid());
+	for (int t = 0; t < 4; ++t)
+		threads[t] = std::thread([&values, &sums, &selected, &query, &second, t]()
+		{
+			const Json::JsonObject& a = values["a"];
+			for (auto it = a.ArrayConstBegin(); it != a.ArrayConstEnd(); ++it)
+				sums[t] += it->AsInt64();
+			vector<const Json::JsonObject*> matches;
+			query.Select(values, matches);
+			for (const Json::JsonObject* match : matches)
+				sums[t] += match->AsInt64();
+			sums[t] += a[1].AsInt64();
+			selected[t] = second.SelectFirst(values);
+		});
+	for (std::thread& thread : threads)
+		thread.join();
+	for (int t = 0; t < 4; ++t)
+	{
+		EXPECT_EQ(sums[t], 2 * (1 - 2 + 3 + 5000000000LL) - 2);
+		// Readers share the values built for the array.
+		EXPECT_EQ(selected[t], &values["b"][1]);
+	}
+	EXPECT_EQ(values["b"][1].AsDouble(), 1.5);
+
+	EXPECT_EQ(values["a"].GetElement(3).GetType(), ValueType::UInt64);
+	EXPECT_EQ(values["b"].GetElement(1).AsDouble(), 1.5);
+	EXPECT_TRUE(values["b"].GetElement(2).IsNull());
+	Json::JsonObject element;
+	ASSERT_TRUE(JsonQuery::Compile("$.a[-1]").ForEach(values, [&element](const Json::JsonObject& match) { element = Json::JsonObject(match); return true; }));
+	EXPECT_EQ(element.AsUInt64(), 5000000000ULL);
+	EXPECT_TRUE(values["a"].IsPackedArray());
+	EXPECT_EQ(values["a"].AsInt64Array().size(), 4u);
+	EXPECT_TRUE(values["b"].IsPackedArray());
+
+	// Non-const access unpacks.
+	root["a"][0] = Json::JsonObject("x");
+	EXPECT_FALSE(root["a"].IsPackedArray());
+	EXPECT_EQ(root["a"][1].AsInt(), -2);
+}
+
+TEST(JsonReaderTests, PackedArraysEqualUnpacked)
+{
+	JsonReader packedReader, reader;
+	packedReader.SetPackedArrays(true);
+	for (const char* json : { "[1.5,2]", "[2,1.5]", "[1,2,3]", "[0.5,-1e3]", "[1,9007199254740993,2.5]", "[1,18446744073709551615]" })
+	{
+		Json::JsonObject packed, unpacked;
+		ASSERT_TRUE(packedReader.Parse(string(json), packed));
+		ASSERT_TRUE(reader.Parse(string(json), unpacked));
+		EXPECT_TRUE(packed == unpacked) << json;
+		EXPECT_EQ(packed.Hash(), unpacked.Hash()) << json;
+		for (int i = 0; i < unpacked.Size(); ++i)
+			EXPECT_EQ(packed.GetElement(i).GetType(), unpacked.GetElement(i).GetType()) << json;
+	}
+
+	// Arrays with both integers and reals are not packed.
+	Json::JsonObject root;
+	ASSERT_TRUE(packedReader.Parse(string("[[1.5,2],[1,2],[1.5,2.5]]"), root));
+	const Json::JsonObject& arrays = root;
+	EXPECT_FALSE(arrays[0].IsPackedArray());
+	EXPECT_TRUE(arrays[1].IsPackedArray());
+	EXPECT_TRUE(arrays[2].IsPackedArray());
+}
+
+TEST(JsonReaderTests, ParallelParseAllowsMaxDepth)
+{
+	// Root array large enough to be split, its elements nest to exactly the limit.
+	string json = "[";
+	while (json.length() < (size_t(5) << 20))
+		json += "[[1]],";
+	json += "[[2]]]";
+
+	for (unsigned int threadCount : { 1u, 4u })
+	{
+		JsonReader reader;
+		reader.SetThreadCount(threadCount);
+		reader.SetMaxDepth(3);
+		Json::JsonObject root;
+		ASSERT_TRUE(reader.Parse(json, root)) << threadCount << " threads: " << reader.GetErrorMessage();
+		EXPECT_EQ(root[root.Size() - 1][0][0].AsInt(), 2);
+
+		reader.SetMaxDepth(2);
+		EXPECT_FALSE(reader.Parse(json, root)) << threadCount << " threads";
+	}
+}
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "JsonReader.h"
+#include "JsonWriter.h"
+
+using namespace Json;
+
+TEST(JsonWriterTests, EmptyContainersAreClosed)
+{
+	JsonReader reader;
+	JsonWriter writer;
+	Json::JsonObject root;
+	ASSERT_TRUE(reader.Parse(string(R"({"object":{},"array":[],"nested":[[],{}]})"), root));
+
+	for (bool styled : { false, true })
+	{
+		string json;
+		ASSERT_TRUE(writer.Write(json, root, styled));
+		Json::JsonObject written;
+		ASSERT_TRUE(reader.Parse(json, written)) << json;
+		EXPECT_TRUE(written == root) << json;
+	}
+
+	string json;
+	ASSERT_TRUE(writer.Write(json, Json::JsonObject(ValueType::Array), false));
+	EXPECT_EQ(json, "[]");
+	json.clear();
+	ASSERT_TRUE(writer.Write(json, Json::JsonObject(ValueType::Object), false));
+	EXPECT_EQ(json, "{}");
+}